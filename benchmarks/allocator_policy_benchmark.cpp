@@ -0,0 +1,48 @@
+#include <string>
+#include "queue.hpp"
+#include "block_allocator.hpp"
+#include "benchmark.hpp"
+
+// Кэш узлов отключён, чтобы каждое push/pop доходило до распределителя.
+template<typename Q>
+void run(const std::string& label, Q& q, size_t n, size_t depth) {
+    q.set_node_cache_limit(0);
+    for (size_t i = 0; i < depth; ++i) {
+        q.push(static_cast<long long>(i));
+    }
+    long long sink = 0;
+    bench::measure(label + " depth=" + std::to_string(depth), n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            q.push(static_cast<long long>(i));
+            sink += q.pop_value();
+        }
+    });
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {10000000})) {
+        for (size_t depth : {1, 64}) {
+            {
+                BlockMemoryResource mr;
+                Queue<long long> q(&mr);
+                run("pmr BlockMemoryResource", q, n, depth);
+            }
+            {
+                std::pmr::unsynchronized_pool_resource mr;
+                Queue<long long> q(&mr);
+                run("pmr unsynchronized_pool_resource", q, n, depth);
+            }
+            {
+                Queue<long long, std::allocator<long long>> q;
+                run("std::allocator", q, n, depth);
+            }
+            {
+                BlockPool pool;
+                Queue<long long, BlockAllocator<long long>> q{BlockAllocator<long long>(pool)};
+                run("BlockAllocator", q, n, depth);
+            }
+        }
+    }
+    return 0;
+}
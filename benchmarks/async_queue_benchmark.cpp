@@ -0,0 +1,92 @@
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "queue.hpp"
+#include "async_queue.hpp"
+#include "benchmark.hpp"
+
+AsyncTask pinger(std::allocator_arg_t, std::pmr::memory_resource*, 
+                 AsyncQueue<long long>& ping, AsyncQueue<long long>& pong, size_t rounds, long long& sink) {
+    for (size_t i = 0; i < rounds; ++i) {
+        ping.push(static_cast<long long>(i));
+        sink += co_await pong.pop_async();
+    }
+}
+
+AsyncTask ponger(std::allocator_arg_t, std::pmr::memory_resource*, 
+                 AsyncQueue<long long>& ping, AsyncQueue<long long>& pong, size_t rounds) {
+    for (size_t i = 0; i < rounds; ++i) {
+        pong.push(co_await ping.pop_async() + 1);
+    }
+}
+
+struct Channel {
+    Queue<long long> queue;
+    std::mutex mutex;
+    std::condition_variable ready;
+
+    void push(long long value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push(value);
+        }
+        ready.notify_one();
+    }
+
+    long long pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return !queue.empty(); });
+        long long value = queue.front();
+        queue.pop();
+        return value;
+    }
+};
+
+int main(int argc, char** argv) {
+    for (size_t rounds : bench::sizes_from_args(argc, argv, {1000000})) {
+        std::string prefix = "rounds=" + std::to_string(rounds);
+        long long sink = 0;
+        {
+            BlockMemoryResource mr;
+            AsyncQueue<long long> ping(&mr), pong(&mr);
+            bench::measure(prefix + " coroutine ping-pong inline", rounds, [&] {
+                AsyncTask b = ponger(std::allocator_arg, &mr, ping, pong, rounds);
+                AsyncTask a = pinger(std::allocator_arg, &mr, ping, pong, rounds, sink);
+            });
+        }
+        {
+            BlockMemoryResource mr;
+            Queue<std::coroutine_handle<>> ready(&mr);
+            auto executor = [&ready](std::coroutine_handle<> h) { ready.push(std::move(h)); };
+            AsyncQueue<long long> ping(&mr, executor), pong(&mr, executor);
+            bench::measure(prefix + " coroutine ping-pong executor", rounds, [&] {
+                AsyncTask b = ponger(std::allocator_arg, &mr, ping, pong, rounds);
+                AsyncTask a = pinger(std::allocator_arg, &mr, ping, pong, rounds, sink);
+                while (!ready.empty()) {
+                    auto h = ready.front();
+                    ready.pop();
+                    h.resume();
+                }
+            });
+        }
+        {
+            size_t thread_rounds = rounds / 10;
+            Channel ping, pong;
+            bench::measure(prefix + "/10 thread ping-pong", thread_rounds, [&] {
+                std::thread other([&] {
+                    for (size_t i = 0; i < thread_rounds; ++i) {
+                        pong.push(ping.pop() + 1);
+                    }
+                });
+                for (size_t i = 0; i < thread_rounds; ++i) {
+                    ping.push(static_cast<long long>(i));
+                    sink += pong.pop();
+                }
+                other.join();
+            });
+        }
+        bench::do_not_optimize(sink);
+    }
+    return 0;
+}
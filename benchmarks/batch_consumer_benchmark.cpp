@@ -0,0 +1,82 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include "blocking_queue.hpp"
+#include "benchmark.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Под нагрузкой: производитель заливает n элементов, потребитель забирает их
+// по одному или пакетами consume().
+void saturated(size_t n) {
+    std::string prefix = "saturated n=" + std::to_string(n);
+    long long sink = 0;
+    {
+        BlockingQueue<long long> q;
+        bench::measure(prefix + " pop_for per item", n, [&] {
+            std::thread producer([&] {
+                for (size_t i = 0; i < n; ++i) {
+                    q.push(static_cast<long long>(i));
+                }
+            });
+            for (size_t received = 0; received < n;) {
+                if (auto v = q.pop_for(std::chrono::milliseconds(10))) {
+                    sink += *v;
+                    ++received;
+                }
+            }
+            producer.join();
+        });
+    }
+    {
+        BlockingQueue<long long> q;
+        bench::measure(prefix + " consume(256)", n, [&] {
+            std::thread producer([&] {
+                for (size_t i = 0; i < n; ++i) {
+                    q.push(static_cast<long long>(i));
+                }
+            });
+            for (size_t received = 0; received < n;) {
+                received += q.consume(256, std::chrono::milliseconds(10), [&](std::span<long long> batch) {
+                    for (long long v : batch) {
+                        sink += v;
+                    }
+                });
+            }
+            producer.join();
+        });
+    }
+    bench::do_not_optimize(sink);
+}
+
+// Слабый поток: элемент раз в 100 мкс; меряем задержку от push до обработки.
+void light(size_t n) {
+    BlockingQueue<Clock::time_point> q;
+    double total_ns = 0.0;
+    std::thread producer([&] {
+        for (size_t i = 0; i < n; ++i) {
+            q.push(Clock::now());
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+    for (size_t received = 0; received < n;) {
+        received += q.consume(256, std::chrono::milliseconds(10), [&](std::span<Clock::time_point> batch) {
+            auto now = Clock::now();
+            for (auto pushed : batch) {
+                total_ns += std::chrono::duration<double, std::nano>(now - pushed).count();
+            }
+        });
+    }
+    producer.join();
+    std::printf("%-48s %10.2f us mean latency, batch limit %zu\n", 
+                ("light n=" + std::to_string(n) + " consume(256)").c_str(), 
+                total_ns / static_cast<double>(n) / 1000.0, q.current_batch_limit());
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000})) {
+        saturated(n);
+        light(std::min<size_t>(n, 2000));
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include "perf_counters.hpp"
+#define BENCH_HAS_PERF_COUNTERS 1
+#else
+#define BENCH_HAS_PERF_COUNTERS 0
+#endif
+
+namespace bench {
+
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+inline std::vector<size_t> sizes_from_args(int argc, char** argv, std::vector<size_t> defaults) {
+    if (argc <= 1) {
+        return defaults;
+    }
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    return sizes;
+}
+
+// Печатает время сценария и, где ядро даёт аппаратные счётчики, их значения
+// в пересчёте на операцию второй строкой.
+template<typename F>
+double measure(const std::string& name, size_t ops, F&& f) {
+#if BENCH_HAS_PERF_COUNTERS
+    PerfCounterSet* counters = default_perf_counters();
+    if (counters) {
+        counters->start();
+    }
+#endif
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto finish = std::chrono::steady_clock::now();
+#if BENCH_HAS_PERF_COUNTERS
+    std::vector<std::pair<const char*, uint64_t>> events;
+    if (counters) {
+        events = counters->stop();
+    }
+#endif
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    double per_op = ops ? ns / static_cast<double>(ops) : 0.0;
+    std::printf("%-48s %12.3f ms %10.2f ns/op\n", name.c_str(), ns / 1e6, per_op);
+#if BENCH_HAS_PERF_COUNTERS
+    if (!events.empty() && ops) {
+        std::printf("%-48s", "");
+        for (const auto& [event, value] : events) {
+            std::printf(" %s/op=%.2f", event, static_cast<double>(value) / static_cast<double>(ops));
+        }
+        std::printf("\n");
+    }
+#endif
+    return ns;
+}
+
+}
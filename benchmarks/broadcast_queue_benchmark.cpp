@@ -0,0 +1,64 @@
+#include <string>
+#include <vector>
+#include "queue.hpp"
+#include "broadcast_queue.hpp"
+#include "benchmark.hpp"
+
+struct Message {
+    long long id;
+    char payload[120];
+};
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000})) {
+        for (size_t subscribers : {1, 4, 16}) {
+            std::string prefix = "n=" + std::to_string(n) + " subscribers=" + std::to_string(subscribers);
+            long long sink = 0;
+            // Сообщения приходят пачками по 64, подписчики читают после каждой пачки
+            const size_t batch = 64;
+            {
+                std::vector<Queue<Message>> copies(subscribers);
+                bench::measure(prefix + " Queue per subscriber", n, [&] {
+                    for (size_t i = 0; i < n; i += batch) {
+                        for (size_t j = i; j < i + batch && j < n; ++j) {
+                            Message m{static_cast<long long>(j), {}};
+                            for (auto& q : copies) {
+                                q.push(m);
+                            }
+                        }
+                        for (auto& q : copies) {
+                            while (!q.empty()) {
+                                sink += q.front().id;
+                                q.pop();
+                            }
+                        }
+                    }
+                });
+            }
+            {
+                BroadcastQueue<Message> q;
+                std::vector<BroadcastQueue<Message>::subscriber_id> ids;
+                for (size_t s = 0; s < subscribers; ++s) {
+                    ids.push_back(q.subscribe());
+                }
+                bench::measure(prefix + " BroadcastQueue", n, [&] {
+                    for (size_t i = 0; i < n; i += batch) {
+                        for (size_t j = i; j < i + batch && j < n; ++j) {
+                            q.push(Message{static_cast<long long>(j), {}});
+                        }
+                        for (auto id : ids) {
+                            while (const Message* m = q.try_front(id)) {
+                                sink += m->id;
+                                q.pop(id);
+                            }
+                        }
+                    }
+                });
+            }
+            std::printf("%-48s payload bytes per batch: copies=%zu shared=%zu\n", prefix.c_str(), 
+                        batch * subscribers * sizeof(Message), batch * sizeof(Message));
+            bench::do_not_optimize(sink);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "coalescing_queue.hpp"
+#include "benchmark.hpp"
+
+struct Quote {
+    long long seq;
+    double bid;
+    double ask;
+};
+
+// Ключи с распределением Ципфа: несколько "горячих" инструментов получают
+// большую часть обновлений. Производитель кладёт пачку, потребитель
+// применяет всё, что накопилось; без слияния он применяет и устаревшие.
+std::vector<int> zipf_keys(size_t n, int key_count, double skew) {
+    std::vector<double> weights(static_cast<size_t>(key_count));
+    for (int k = 0; k < key_count; ++k) {
+        weights[static_cast<size_t>(k)] = 1.0 / std::pow(k + 1, skew);
+    }
+    std::discrete_distribution<int> dist(weights.begin(), weights.end());
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    for (int& key : keys) {
+        key = dist(rng);
+    }
+    return keys;
+}
+
+// Применение обновления: немного работы на каждый выданный элемент
+void apply(std::vector<Quote>& book, int key, const Quote& quote) {
+    Quote& slot = book[static_cast<size_t>(key)];
+    slot = quote;
+    slot.bid = std::sqrt(slot.bid * slot.ask);
+}
+
+int main(int argc, char** argv) {
+    const int key_count = 10000;
+    const size_t burst = 4096;
+    for (size_t n : bench::sizes_from_args(argc, argv, {2000000})) {
+        for (double skew : {0.0, 0.99, 1.2}) {
+            std::vector<int> keys = zipf_keys(n, key_count, skew);
+            std::vector<Quote> book(key_count);
+            std::string prefix = "n=" + std::to_string(n) + " zipf=" + std::to_string(skew).substr(0, 4);
+            {
+                std::pmr::unsynchronized_pool_resource mr;
+                Queue<std::pair<int, Quote>> q(&mr);
+                size_t applied = 0;
+                bench::measure(prefix + " Queue, every update applied", n, [&] {
+                    for (size_t i = 0; i < n; ++i) {
+                        q.push(std::pair<int, Quote>(keys[i], Quote{static_cast<long long>(i), 1.0, 2.0}));
+                        if ((i + 1) % burst == 0 || i + 1 == n) {
+                            while (auto item = q.try_pop()) {
+                                apply(book, item->first, item->second);
+                                ++applied;
+                            }
+                        }
+                    }
+                });
+                bench::do_not_optimize(book[0].bid);
+                std::printf("  applied %zu\n", applied);
+            }
+            {
+                std::pmr::unsynchronized_pool_resource mr;
+                CoalescingQueue<int, Quote> q(&mr);
+                q.reserve(key_count);
+                size_t applied = 0;
+                bench::measure(prefix + " CoalescingQueue", n, [&] {
+                    for (size_t i = 0; i < n; ++i) {
+                        q.push(keys[i], Quote{static_cast<long long>(i), 1.0, 2.0});
+                        if ((i + 1) % burst == 0 || i + 1 == n) {
+                            while (auto item = q.try_pop()) {
+                                apply(book, item->first, item->second);
+                                ++applied;
+                            }
+                        }
+                    }
+                });
+                bench::do_not_optimize(book[0].bid);
+                std::printf("  applied %zu, coalesced %zu\n", applied, q.coalesced());
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <string>
+#include "queue.hpp"
+#include "benchmark.hpp"
+
+struct Order {
+    long long id;
+    double price;
+    bool cancelled;
+};
+
+// Каждый сотый ордер отменён; сравниваем erase_if с прежним способом -
+// перекладыванием выживших через pop/push в новую очередь.
+void fill(Queue<Order>& q, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        q.push(Order{static_cast<long long>(i), 100.0 + static_cast<double>(i % 50), i % 100 == 37});
+    }
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {10000000})) {
+        std::string prefix = "n=" + std::to_string(n) + " cancelled=1%";
+        {
+            Queue<Order> q;
+            fill(q, n);
+            bench::measure(prefix + " rebuild via pop/push", n, [&] {
+                Queue<Order> survivors;
+                while (!q.empty()) {
+                    Order o = q.pop_value();
+                    if (!o.cancelled) {
+                        survivors.push(o);
+                    }
+                }
+                q = std::move(survivors);
+            });
+            bench::do_not_optimize(q.size());
+        }
+        {
+            Queue<Order> q;
+            fill(q, n);
+            bench::measure(prefix + " erase_if", n, [&] {
+                q.erase_if([](const Order& o) { return o.cancelled; });
+            });
+            bench::do_not_optimize(q.size());
+        }
+        {
+            Queue<Order> q;
+            q.enable_segments(4096);
+            q.enable_index();
+            fill(q, n);
+            bench::measure(prefix + " erase_if segments+index", n, [&] {
+                q.erase_if([](const Order& o) { return o.cancelled; });
+            });
+            bench::do_not_optimize(q.size());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "queue.hpp"
+#include "huge_page_memory_resource.hpp"
+#include "benchmark.hpp"
+
+// Слоты под узлы берутся одним куском из upstream и раздаются в случайном
+// порядке: обход очереди прыгает по всей арене и упирается в TLB.
+class ShuffledSlotResource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+    std::vector<char*> slots;
+    size_t next = 0;
+    size_t slot_size;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes > slot_size || next == slots.size()) {
+            return upstream->allocate(bytes, alignment);
+        }
+        return slots[next++];
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    ShuffledSlotResource(std::pmr::memory_resource* upstream_mr, size_t count, size_t size)
+        : upstream(upstream_mr), slots(count), slot_size(size) {
+        char* arena = static_cast<char*>(upstream->allocate(slot_size * count, alignof(std::max_align_t)));
+        for (size_t i = 0; i < count; ++i) {
+            slots[i] = arena + i * slot_size;
+        }
+        std::shuffle(slots.begin(), slots.end(), std::mt19937_64(42));
+    }
+};
+
+void run(const std::string& label, size_t n, bool huge_pages) {
+    HugePageMemoryResource::Options options;
+    options.huge_pages = huge_pages;
+    HugePageMemoryResource backing(options);
+    ShuffledSlotResource slots(&backing, n, sizeof(QueueNode<long long>));
+    {
+        Queue<long long> q(&slots);
+        for (size_t i = 0; i < n; ++i) {
+            q.push(static_cast<long long>(i));
+        }
+
+        // dTLB-промахи на операцию печатает сам bench::measure
+        long long sink = 0;
+        bench::measure(label + " n=" + std::to_string(n), n, [&] {
+            for (long long v : q) {
+                sink += v;
+            }
+        });
+        bench::do_not_optimize(sink);
+    }
+    std::printf("%-48s huge_pages=%d numa_node=%d mapped=%zu MB\n", "",
+                backing.huge_pages_enabled() ? 1 : 0, backing.numa_node(), backing.mapped_bytes() >> 20);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000, 10000000})) {
+        run("traverse 4K pages", n, false);
+        run("traverse huge pages", n, true);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <string>
+#include <vector>
+#include "queue.hpp"
+#include "benchmark.hpp"
+
+// Пачки: push burst элементов, затем столько же pop. Кэш узлов отключён,
+// чтобы каждая операция доходила до ресурса.
+void run(const std::string& label, std::pmr::memory_resource* mr, size_t n, size_t burst) {
+    Queue<long long> q(mr);
+    q.set_node_cache_limit(0);
+    long long sink = 0;
+    bench::measure(label + " burst=" + std::to_string(burst), n, [&] {
+        for (size_t done = 0; done < n; done += burst) {
+            for (size_t i = 0; i < burst; ++i) {
+                q.push(static_cast<long long>(i));
+            }
+            for (size_t i = 0; i < burst; ++i) {
+                sink += q.pop_value();
+            }
+        }
+    });
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {2000000})) {
+        for (size_t burst : {1, 64}) {
+            {
+                BlockMemoryResource mr;
+                run("Block -> new_delete", &mr, n, burst);
+            }
+            {
+                alignas(std::max_align_t) std::byte stack_buffer[64 * 1024];
+                std::pmr::monotonic_buffer_resource arena(stack_buffer, sizeof(stack_buffer));
+                BlockMemoryResource mr(&arena);
+                run("Block -> monotonic(stack 64K)", &mr, n, burst);
+            }
+            {
+                std::pmr::unsynchronized_pool_resource pool;
+                BlockMemoryResource mr(&pool);
+                run("Block -> unsynchronized_pool", &mr, n, burst);
+            }
+            {
+                std::pmr::unsynchronized_pool_resource pool;
+                run("unsynchronized_pool", &pool, n, burst);
+            }
+            run("new_delete", std::pmr::new_delete_resource(), n, burst);
+        }
+    }
+    return 0;
+}
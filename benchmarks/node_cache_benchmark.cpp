@@ -0,0 +1,36 @@
+#include <string>
+#include "queue.hpp"
+#include "benchmark.hpp"
+
+// Установившийся режим: в очереди держится depth элементов, каждый шаг
+// добавляет один и извлекает один.
+void run(const std::string& label, std::pmr::memory_resource* mr, size_t n, size_t depth, size_t cache_limit) {
+    Queue<long long> q(mr);
+    q.set_node_cache_limit(cache_limit);
+    for (size_t i = 0; i < depth; ++i) {
+        q.push(static_cast<long long>(i));
+    }
+    long long sink = 0;
+    bench::measure(label + " depth=" + std::to_string(depth) + " cache=" + std::to_string(cache_limit), n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            q.push(static_cast<long long>(i));
+            sink += q.pop_value();
+        }
+    });
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {10000000})) {
+        for (size_t depth : {1, 16}) {
+            for (size_t cache : {0, 32}) {
+                BlockMemoryResource block;
+                run("BlockMemoryResource", &block, n, depth, cache);
+                std::pmr::unsynchronized_pool_resource pool;
+                run("unsynchronized_pool_resource", &pool, n, depth, cache);
+                run("new_delete_resource", std::pmr::new_delete_resource(), n, depth, cache);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <thread>
+#include "queue.hpp"
+#include "parallel_algorithms.hpp"
+#include "benchmark.hpp"
+
+struct Employee {
+    std::string name;
+    int id;
+    double salary;
+    std::string department;
+};
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000, 4000000})) {
+        Queue<Employee> q;
+        q.enable_segments(4096);
+        for (size_t i = 0; i < n; ++i) {
+            q.push(Employee{"Employee " + std::to_string(i), static_cast<int>(i), 
+                            1000.0 + static_cast<double>(i % 977), "Engineering"});
+        }
+        
+        std::string prefix = "n=" + std::to_string(n);
+        double sink = 0.0;
+        bench::measure(prefix + " sequential accumulate", n, [&] {
+            sink += std::accumulate(q.begin(), q.end(), 0.0, 
+                                    [](double acc, const Employee& e) { return acc + e.salary; });
+        });
+        bench::measure(prefix + " sequential find_if", n, [&] {
+            auto it = std::find_if(q.begin(), q.end(), [n](const Employee& e) { 
+                return static_cast<size_t>(e.id) == n - 1; 
+            });
+            sink += it->salary;
+        });
+        
+        size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            ThreadPool pool(threads);
+            std::string label = prefix + " threads=" + std::to_string(threads);
+            bench::measure(label + " parallel_reduce", n, [&] {
+                sink += parallel_transform_reduce(q, pool, 0.0, std::plus<>(), 
+                                                  [](const Employee& e) { return e.salary; });
+            });
+            bench::measure(label + " parallel_find_if", n, [&] {
+                auto it = parallel_find_if(q, pool, [n](const Employee& e) { 
+                    return static_cast<size_t>(e.id) == n - 1; 
+                });
+                sink += it->salary;
+            });
+            bench::measure(label + " parallel_for_each", n, [&] {
+                parallel_for_each(q, pool, [](Employee& e) { e.salary += 1.0; });
+            });
+        }
+        bench::do_not_optimize(sink);
+    }
+    return 0;
+}
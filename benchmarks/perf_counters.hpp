@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace bench {
+
+// Один аппаратный счётчик через perf_event_open, только пользовательский
+// режим. Если ядро или виртуалка счётчик не дают, available() == false,
+// а stop() возвращает 0. Когда счётчиков больше, чем регистров PMU, ядро
+// их мультиплексирует - значение масштабируется на долю времени работы.
+// Счётчик наследуется (inherit): в него попадают потоки и дочерние процессы,
+// созданные после его открытия. Ядро не обнуляет накопленное завершившимися
+// потомками по RESET, поэтому stop() возвращает разность с чтением в start().
+class PerfCounter {
+private:
+    int fd = -1;
+    uint64_t baseline[3] = {0, 0, 0};
+
+    bool read_values(uint64_t (&values)[3]) const {
+        return read(fd, values, sizeof(values)) == sizeof(values);
+    }
+
+public:
+    PerfCounter(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    ~PerfCounter() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    bool available() const {
+        return fd >= 0;
+    }
+
+    void start() {
+        if (fd >= 0) {
+            if (!read_values(baseline)) {
+                baseline[0] = baseline[1] = baseline[2] = 0;
+            }
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    uint64_t stop() {
+        if (fd < 0) {
+            return 0;
+        }
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t values[3] = {0, 0, 0};
+        if (!read_values(values)) {
+            return 0;
+        }
+        uint64_t count = values[0] - baseline[0];
+        uint64_t enabled = values[1] - baseline[1];
+        uint64_t running = values[2] - baseline[2];
+        if (running == 0) {
+            return 0;
+        }
+        if (running < enabled) {
+            return static_cast<uint64_t>(static_cast<double>(count) * enabled / running);
+        }
+        return count;
+    }
+};
+
+inline constexpr uint64_t hw_cache_read_miss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+inline constexpr uint64_t dtlb_read_misses = hw_cache_read_miss(PERF_COUNT_HW_CACHE_DTLB);
+
+struct PerfEventSpec {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+inline constexpr PerfEventSpec default_perf_events[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"L1d-misses", PERF_TYPE_HW_CACHE, hw_cache_read_miss(PERF_COUNT_HW_CACHE_L1D)},
+    {"LLC-misses", PERF_TYPE_HW_CACHE, hw_cache_read_miss(PERF_COUNT_HW_CACHE_LL)},
+    {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"dTLB-misses", PERF_TYPE_HW_CACHE, dtlb_read_misses},
+};
+
+// Набор счётчиков вокруг одного сценария; недоступные молча пропускаются
+class PerfCounterSet {
+private:
+    std::vector<std::pair<const char*, std::unique_ptr<PerfCounter>>> counters;
+
+public:
+    template<size_t N>
+    explicit PerfCounterSet(const PerfEventSpec (&events)[N]) {
+        for (const PerfEventSpec& event : events) {
+            auto counter = std::make_unique<PerfCounter>(event.type, event.config);
+            if (counter->available()) {
+                counters.emplace_back(event.name, std::move(counter));
+            }
+        }
+    }
+
+    bool empty() const {
+        return counters.empty();
+    }
+
+    void start() {
+        for (auto& [name, counter] : counters) {
+            counter->start();
+        }
+    }
+
+    std::vector<std::pair<const char*, uint64_t>> stop() {
+        std::vector<std::pair<const char*, uint64_t>> values;
+        values.reserve(counters.size());
+        for (auto& [name, counter] : counters) {
+            values.emplace_back(name, counter->stop());
+        }
+        return values;
+    }
+};
+
+// Общий набор для bench::measure; BENCH_PERF=0 отключает счётчики.
+// Открывается при старте программы (см. perf_counters_at_startup), чтобы
+// рабочие потоки и процессы сценариев унаследовали счётчики, где бы их ни
+// создали.
+inline PerfCounterSet* default_perf_counters() {
+    static std::unique_ptr<PerfCounterSet> set = [] {
+        const char* env = std::getenv("BENCH_PERF");
+        if (env && std::string(env) == "0") {
+            return std::unique_ptr<PerfCounterSet>();
+        }
+        auto counters = std::make_unique<PerfCounterSet>(default_perf_events);
+        if (counters->empty()) {
+            std::fprintf(stderr, "perf_event_open: hardware counters are not available, reporting time only\n");
+        }
+        return counters;
+    }();
+    return set && !set->empty() ? set.get() : nullptr;
+}
+
+inline PerfCounterSet* const perf_counters_at_startup = default_perf_counters();
+
+}
@@ -0,0 +1,52 @@
+#include <filesystem>
+#include <string>
+#include "queue.hpp"
+#include "persistent_queue.hpp"
+#include "benchmark.hpp"
+
+struct Record {
+    long long id;
+    double values[6];
+};
+
+int main(int argc, char** argv) {
+    std::string path = (std::filesystem::temp_directory_path() / "persistent_queue_benchmark.q").string();
+    for (size_t n : bench::sizes_from_args(argc, argv, {100000})) {
+        std::string prefix = "n=" + std::to_string(n);
+        {
+            Queue<Record> q;
+            bench::measure(prefix + " volatile Queue push+pop", n, [&] {
+                for (size_t i = 0; i < n; ++i) {
+                    q.push(Record{static_cast<long long>(i), {}});
+                }
+                while (!q.empty()) {
+                    q.pop();
+                }
+            });
+        }
+        
+        for (size_t interval : {0, 4096, 256, 16}) {
+            std::filesystem::remove(path);
+            MappedFileMemoryResource mr(path, (n + 1) * 96 + (1 << 16));
+            PersistentQueue<Record> q(mr, interval);
+            bench::measure(prefix + " persistent sync_every=" + std::to_string(interval), n, [&] {
+                for (size_t i = 0; i < n; ++i) {
+                    q.push(Record{static_cast<long long>(i), {}});
+                }
+                while (!q.empty()) {
+                    q.pop();
+                }
+            });
+        }
+
+        {
+            MappedFileMemoryResource mr(path, 0);
+            bench::measure(prefix + " reopen", 1, [&] {
+                PersistentQueue<Record> q(mr);
+                bench::do_not_optimize(q.size());
+            });
+        }
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
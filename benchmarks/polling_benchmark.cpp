@@ -0,0 +1,58 @@
+#include <stdexcept>
+#include <string>
+#include "queue.hpp"
+#include "benchmark.hpp"
+
+// Разные способы опросить очередь до опустошения. Наполнение идёт вне
+// замера; первый прогон прогревает аллокатор, меряется второй.
+void fill(Queue<long long>& q, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        q.push(static_cast<long long>(i));
+    }
+}
+
+template<typename Drain>
+void run(const std::string& name, size_t n, Drain drain) {
+    Queue<long long> q;
+    long long sink = 0;
+    fill(q, n);
+    drain(q, sink);
+    fill(q, n);
+    bench::measure(name, n, [&] {
+        drain(q, sink);
+    });
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000})) {
+        std::string prefix = "n=" + std::to_string(n);
+        run(prefix + " empty()+front()+pop()", n, [](Queue<long long>& q, long long& sink) {
+            while (!q.empty()) {
+                sink += q.front();
+                q.pop();
+            }
+        });
+        run(prefix + " try/catch front()+pop()", n, [](Queue<long long>& q, long long& sink) {
+            while (true) {
+                try {
+                    sink += q.front();
+                    q.pop();
+                } catch (const std::runtime_error&) {
+                    break;
+                }
+            }
+        });
+        run(prefix + " try_pop()", n, [](Queue<long long>& q, long long& sink) {
+            while (auto v = q.try_pop()) {
+                sink += *v;
+            }
+        });
+        run(prefix + " try_front()+pop_value()", n, [](Queue<long long>& q, long long& sink) {
+            while (q.try_front()) {
+                sink += q.pop_value();
+            }
+        });
+    }
+    return 0;
+}
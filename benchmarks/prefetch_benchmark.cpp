@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "queue.hpp"
+#include "benchmark.hpp"
+
+struct Record {
+    long long key;
+    double values[14];
+};
+
+// Узлы раскладываются в случайном порядке по памяти, чтобы обход был
+// настоящим pointer-chase, а не последовательным чтением.
+template<typename T>
+class ScatteredResource : public std::pmr::memory_resource {
+private:
+    std::vector<char*> slots;
+    size_t next = 0;
+    size_t slot_size;
+    char* arena = nullptr;
+
+    void* do_allocate(size_t bytes, size_t) override {
+        if (bytes > slot_size || next == slots.size()) {
+            return ::operator new(bytes);
+        }
+        return slots[next++];
+    }
+
+    void do_deallocate(void* p, size_t, size_t) override {
+        char* c = static_cast<char*>(p);
+        if (c < arena || c >= arena + slot_size * slots.size()) {
+            ::operator delete(p);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit ScatteredResource(size_t count) : slots(count), slot_size(sizeof(QueueNode<T>)) {
+        arena = static_cast<char*>(::operator new(slot_size * count));
+        for (size_t i = 0; i < count; ++i) {
+            slots[i] = arena + i * slot_size;
+        }
+        std::shuffle(slots.begin(), slots.end(), std::mt19937_64(42));
+    }
+
+    ~ScatteredResource() override {
+        ::operator delete(arena);
+    }
+};
+
+template<typename T, typename Make, typename Touch>
+void run(const std::string& label, size_t n, Make make, Touch touch) {
+    ScatteredResource<T> mr(n);
+    Queue<T> q(&mr);
+    for (size_t i = 0; i < n; ++i) {
+        q.push(make(i));
+    }
+
+    std::string prefix = label + " n=" + std::to_string(n);
+    long long sink = 0;
+    bench::measure(prefix + " plain", n, [&] {
+        for (auto it = q.begin(); it != q.end(); ++it) {
+            sink += touch(*it);
+        }
+    });
+    for (size_t distance : {2, 4, 8, 16, 32}) {
+        bench::measure(prefix + " prefetch d=" + std::to_string(distance), n, [&] {
+            q.for_each_prefetched([&](const T& v) { sink += touch(v); }, distance);
+        });
+    }
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000, 10000000})) {
+        run<long long>("int64", n, 
+            [](size_t i) { return static_cast<long long>(i); },
+            [](long long v) { return v; });
+        run<Record>("record(120B)", n, 
+            [](size_t i) { Record r{}; r.key = static_cast<long long>(i); r.values[13] = 1.0; return r; },
+            [](const Record& r) { return r.key + static_cast<long long>(r.values[13]); });
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <sstream>
+#include <string>
+#include "queue.hpp"
+#include "queue_serialization.hpp"
+#include "benchmark.hpp"
+
+struct Record {
+    long long id;
+    double price;
+    int quantity;
+    int flags;
+};
+
+std::ostream& operator<<(std::ostream& os, const Record& r) {
+    return os << r.id << ' ' << r.price << ' ' << r.quantity << ' ' << r.flags << '\n';
+}
+
+void report_rate(const std::string& name, size_t bytes, double ns) {
+    std::printf("%-48s %12.3f GB/s (%zu bytes)\n", name.c_str(), bytes / ns, bytes);
+}
+
+template<typename T>
+void run(const std::string& label, Queue<T>& q) {
+    size_t n = q.size();
+    std::vector<std::byte> blob;
+    blob.reserve(serialized_size(q));
+    double ns = bench::measure(label + " serialize_queue", n, [&] {
+        blob.clear();
+        serialize_queue(q, blob);
+    });
+    report_rate(label + " serialize_queue", blob.size(), ns);
+
+    std::pmr::monotonic_buffer_resource arena(deserialized_node_bytes<T>(blob));
+    ns = bench::measure(label + " deserialize_queue (monotonic)", n, [&] {
+        Queue<T> restored = deserialize_queue<T>(blob, &arena);
+        bench::do_not_optimize(restored.size());
+    });
+    report_rate(label + " deserialize_queue (monotonic)", blob.size(), ns);
+
+    std::string text;
+    ns = bench::measure(label + " ostream operator<<", n, [&] {
+        std::ostringstream out;
+        for (const T& value : q) {
+            out << value;
+        }
+        text = out.str();
+    });
+    report_rate(label + " ostream operator<<", text.size(), ns);
+}
+
+struct Employee {
+    std::string name;
+    int id;
+    double salary;
+    std::string department;
+};
+
+std::ostream& operator<<(std::ostream& os, const Employee& e) {
+    return os << e.name << ' ' << e.id << ' ' << e.salary << ' ' << e.department << '\n';
+}
+
+template<>
+struct QueueSerializer<Employee> {
+    static size_t size(const Employee& e) {
+        return 2 * sizeof(uint32_t) + e.name.size() + e.department.size() + sizeof(e.id) + sizeof(e.salary);
+    }
+
+    static void write(const Employee& e, std::byte* out) {
+        for (const std::string* s : {&e.name, &e.department}) {
+            uint32_t length = static_cast<uint32_t>(s->size());
+            std::memcpy(out, &length, sizeof(length));
+            std::memcpy(out + sizeof(length), s->data(), length);
+            out += sizeof(length) + length;
+        }
+        std::memcpy(out, &e.id, sizeof(e.id));
+        std::memcpy(out + sizeof(e.id), &e.salary, sizeof(e.salary));
+    }
+
+    static Employee read(const std::byte* in, size_t) {
+        Employee e;
+        for (std::string* s : {&e.name, &e.department}) {
+            uint32_t length;
+            std::memcpy(&length, in, sizeof(length));
+            s->assign(reinterpret_cast<const char*>(in + sizeof(length)), length);
+            in += sizeof(length) + length;
+        }
+        std::memcpy(&e.id, in, sizeof(e.id));
+        std::memcpy(&e.salary, in + sizeof(e.id), sizeof(e.salary));
+        return e;
+    }
+};
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000})) {
+        Queue<Record> records;
+        Queue<Employee> staff;
+        for (size_t i = 0; i < n; ++i) {
+            records.push(Record{static_cast<long long>(i), i * 0.25, static_cast<int>(i % 100), 0});
+            staff.push(Employee{"Employee " + std::to_string(i), static_cast<int>(i), 
+                                1000.0 + static_cast<double>(i % 977), "Engineering"});
+        }
+        run("Record n=" + std::to_string(n), records);
+        run("Employee n=" + std::to_string(n), staff);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "queue.hpp"
+#include "sharded_queue.hpp"
+#include "benchmark.hpp"
+
+// Единственная Queue под одним мьютексом - прежний вариант
+class LockedQueue {
+private:
+    std::mutex mutex;
+    BlockMemoryResource resource;
+    Queue<long long> queue{&resource};
+
+public:
+    void push(long long value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push(value);
+    }
+
+    std::optional<long long> try_pop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.try_pop();
+    }
+};
+
+// Каждый поток чередует push и try_pop; итог - суммарная пропускная
+// способность всех потоков.
+template<typename Q>
+void run(const std::string& label, Q& q, size_t n, size_t threads) {
+    size_t per_thread = n / threads;
+    long long sink = 0;
+    std::mutex sink_mutex;
+    bench::measure(label + " threads=" + std::to_string(threads), per_thread * threads * 2, [&] {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                long long local = 0;
+                for (size_t i = 0; i < per_thread; ++i) {
+                    q.push(static_cast<long long>(i));
+                    if (auto v = q.try_pop()) {
+                        local += *v;
+                    }
+                }
+                std::lock_guard<std::mutex> lock(sink_mutex);
+                sink += local;
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    });
+    while (q.try_pop()) {
+    }
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    size_t max_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+    for (size_t n : bench::sizes_from_args(argc, argv, {4000000})) {
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            LockedQueue locked;
+            run("mutex Queue", locked, n, threads);
+            ShardedQueue<long long> round_robin(threads, ShardProbe::RoundRobin);
+            run("ShardedQueue round-robin", round_robin, n, threads);
+            ShardedQueue<long long> random(threads, ShardProbe::Random);
+            run("ShardedQueue random", random, n, threads);
+        }
+    }
+    return 0;
+}
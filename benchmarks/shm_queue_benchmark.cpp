@@ -0,0 +1,82 @@
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "shm_queue.hpp"
+#include "benchmark.hpp"
+
+struct Message {
+    long long id;
+    double payload[7];
+};
+
+// Производитель - дочерний процесс после fork, потребитель - родитель.
+// Для сравнения те же сообщения идут через socketpair по одному на write.
+void run_shm(size_t n, size_t capacity) {
+    const std::string name = "/oop_lab5_shm_bench_" + std::to_string(getpid());
+    ShmQueue<Message>::unlink(name);
+    ShmQueue<Message> q(name, capacity);
+    long long sink = 0;
+    bench::measure("ShmQueue capacity=" + std::to_string(capacity >> 10) + "KB n=" + std::to_string(n), n, [&] {
+        pid_t child = fork();
+        if (child == 0) {
+            ShmQueue<Message> producer(name, 0);
+            for (size_t i = 0; i < n; ++i) {
+                producer.push(Message{static_cast<long long>(i), {}});
+            }
+            producer.close();
+            _exit(0);
+        }
+        while (auto message = q.pop()) {
+            sink += message->id;
+        }
+        waitpid(child, nullptr, 0);
+    });
+    bench::do_not_optimize(sink);
+    ShmQueue<Message>::unlink(name);
+}
+
+void run_socket(size_t n) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        return;
+    }
+    long long sink = 0;
+    bench::measure("socketpair n=" + std::to_string(n), n, [&] {
+        pid_t child = fork();
+        if (child == 0) {
+            close(fds[0]);
+            for (size_t i = 0; i < n; ++i) {
+                Message message{static_cast<long long>(i), {}};
+                if (write(fds[1], &message, sizeof(message)) != sizeof(message)) {
+                    _exit(1);
+                }
+            }
+            close(fds[1]);
+            _exit(0);
+        }
+        close(fds[1]);
+        Message message;
+        size_t filled = 0;
+        ssize_t got;
+        while ((got = read(fds[0], reinterpret_cast<char*>(&message) + filled, sizeof(message) - filled)) > 0) {
+            filled += static_cast<size_t>(got);
+            if (filled == sizeof(message)) {
+                sink += message.id;
+                filled = 0;
+            }
+        }
+        close(fds[0]);
+        waitpid(child, nullptr, 0);
+    });
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000})) {
+        run_shm(n, size_t(64) << 10);
+        run_shm(n, size_t(16) << 20);
+        run_socket(n);
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include "queue.hpp"
+#include "soa_queue.hpp"
+#include "simd_kernels.hpp"
+#include "benchmark.hpp"
+
+const char* level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+template<typename T>
+void run(const std::string& label, size_t n) {
+    Queue<T> q;
+    SoaQueue<T> soa;
+    for (size_t i = 0; i < n; ++i) {
+        T v = static_cast<T>(i % 1000);
+        q.push(v);
+        soa.push(v);
+    }
+    const T missing = static_cast<T>(-1);
+    std::string prefix = label + " n=" + std::to_string(n);
+    double sink = 0.0;
+
+    bench::measure(prefix + " std::find Queue", n, [&] {
+        sink += static_cast<double>(std::distance(q.begin(), std::find(q.begin(), q.end(), missing)));
+    });
+    bench::measure(prefix + " std::count Queue", n, [&] {
+        sink += static_cast<double>(std::count(q.begin(), q.end(), T(7)));
+    });
+    bench::measure(prefix + " std::accumulate Queue", n, [&] {
+        sink += static_cast<double>(std::accumulate(q.begin(), q.end(), simd_sum_type<T>(0)));
+    });
+    bench::measure(prefix + " std::minmax_element Queue", n, [&] {
+        auto [lo, hi] = std::minmax_element(q.begin(), q.end());
+        sink += static_cast<double>(*lo + *hi);
+    });
+
+    const SimdLevel detected = simd_level();
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2}) {
+        if (level > detected) {
+            continue;
+        }
+        simd_set_level(level);
+        std::string kernel = std::string(" ") + level_name(level);
+        bench::measure(prefix + kernel + " find Queue", n, [&] { sink += static_cast<double>(queue_find(q, missing)); });
+        bench::measure(prefix + kernel + " find SoaQueue", n, [&] { sink += static_cast<double>(queue_find(soa, missing)); });
+        bench::measure(prefix + kernel + " count SoaQueue", n, [&] { sink += static_cast<double>(queue_count(soa, T(7))); });
+        bench::measure(prefix + kernel + " sum Queue", n, [&] { sink += static_cast<double>(queue_sum(q)); });
+        bench::measure(prefix + kernel + " sum SoaQueue", n, [&] { sink += static_cast<double>(queue_sum(soa)); });
+        bench::measure(prefix + kernel + " min_max SoaQueue", n, [&] {
+            auto [lo, hi] = queue_min_max(soa);
+            sink += static_cast<double>(lo + hi);
+        });
+    }
+    simd_set_level(detected);
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000, 100000, 10000000, 100000000})) {
+        run<int32_t>("int32", n);
+        run<double>("double", n);
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <numeric>
+#include <string>
+#include "queue.hpp"
+#include "soa_queue.hpp"
+#include "benchmark.hpp"
+
+struct Employee {
+    std::string name;
+    int id;
+    double salary;
+    std::string department;
+};
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {1000000, 4000000})) {
+        Queue<Employee> aos;
+        SoaQueue<std::string, int, double, std::string> soa;
+        for (size_t i = 0; i < n; ++i) {
+            Employee e{"Employee " + std::to_string(i), static_cast<int>(i),
+                       1000.0 + static_cast<double>(i % 977), "Engineering"};
+            soa.push(e.name, e.id, e.salary, e.department);
+            aos.push(std::move(e));
+        }
+
+        std::string prefix = "n=" + std::to_string(n);
+        double sink = 0.0;
+        bench::measure(prefix + " Queue<Employee> salary sum", n, [&] {
+            sink += std::accumulate(aos.begin(), aos.end(), 0.0,
+                                    [](double acc, const Employee& e) { return acc + e.salary; });
+        });
+        bench::measure(prefix + " SoaQueue salary sum", n, [&] {
+            double sum = 0.0;
+            soa.for_each_chunk<2>([&](std::span<const double> salaries) {
+                sum = std::accumulate(salaries.begin(), salaries.end(), sum);
+            });
+            sink += sum;
+        });
+        bench::measure(prefix + " SoaQueue row-wise salary sum", n, [&] {
+            double sum = 0.0;
+            soa.for_each([&](const std::string&, int, double salary, const std::string&) { sum += salary; });
+            sink += sum;
+        });
+        bench::measure(prefix + " Queue<Employee> drain", n, [&] {
+            while (!aos.empty()) {
+                aos.pop();
+            }
+        });
+        bench::measure(prefix + " SoaQueue drain", n, [&] {
+            while (!soa.empty()) {
+                soa.pop();
+            }
+        });
+        bench::do_not_optimize(sink);
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <string>
+#include "queue.hpp"
+#include "static_queue.hpp"
+#include "benchmark.hpp"
+
+// Установившийся режим с глубиной depth и циклы "заполнить до конца -
+// опустошить" для кольца фиксированной ёмкости и Queue на BlockMemoryResource.
+template<size_t N>
+void run_static(size_t n, size_t depth) {
+    StaticQueue<long long, N> q;
+    for (size_t i = 0; i < depth; ++i) {
+        q.push(static_cast<long long>(i));
+    }
+    long long sink = 0;
+    bench::measure("StaticQueue<" + std::to_string(N) + "> depth=" + std::to_string(depth), n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            q.push(static_cast<long long>(i));
+            sink += q.pop_value();
+        }
+    });
+    q.clear();
+    bench::measure("StaticQueue<" + std::to_string(N) + "> fill/drain", n, [&] {
+        for (size_t done = 0; done < n; done += N) {
+            for (size_t i = 0; i < N; ++i) {
+                q.push(static_cast<long long>(i));
+            }
+            while (!q.empty()) {
+                sink += q.pop_value();
+            }
+        }
+    });
+    bench::do_not_optimize(sink);
+}
+
+void run_queue(size_t n, size_t depth, size_t capacity, size_t cache_limit) {
+    BlockMemoryResource mr;
+    Queue<long long> q(&mr);
+    q.set_node_cache_limit(cache_limit);
+    for (size_t i = 0; i < depth; ++i) {
+        q.push(static_cast<long long>(i));
+    }
+    std::string label = "Queue+BlockMemoryResource cache=" + std::to_string(cache_limit);
+    long long sink = 0;
+    bench::measure(label + " depth=" + std::to_string(depth), n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            q.push(static_cast<long long>(i));
+            sink += q.pop_value();
+        }
+    });
+    q.clear();
+    bench::measure(label + " fill/drain " + std::to_string(capacity), n, [&] {
+        for (size_t done = 0; done < n; done += capacity) {
+            for (size_t i = 0; i < capacity; ++i) {
+                q.push(static_cast<long long>(i));
+            }
+            while (!q.empty()) {
+                sink += q.pop_value();
+            }
+        }
+    });
+    bench::do_not_optimize(sink);
+}
+
+int main(int argc, char** argv) {
+    for (size_t n : bench::sizes_from_args(argc, argv, {10000000})) {
+        run_static<64>(n, 16);
+        run_static<100>(n, 16);
+        run_static<1024>(n, 512);
+        for (size_t cache : {0, 32}) {
+            run_queue(n, 16, 64, cache);
+            run_queue(n, 512, 1024, cache);
+        }
+    }
+    return 0;
+}
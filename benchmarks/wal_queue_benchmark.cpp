@@ -0,0 +1,55 @@
+#include <filesystem>
+#include <string>
+#include "queue.hpp"
+#include "wal_queue.hpp"
+#include "benchmark.hpp"
+
+struct Record {
+    long long id;
+    double values[6];
+};
+
+int main(int argc, char** argv) {
+    auto dir = std::filesystem::temp_directory_path() / "wal_queue_benchmark";
+    for (size_t n : bench::sizes_from_args(argc, argv, {100000})) {
+        std::string prefix = "n=" + std::to_string(n);
+        {
+            Queue<Record> q;
+            bench::measure(prefix + " volatile Queue push+pop", n, [&] {
+                for (size_t i = 0; i < n; ++i) {
+                    q.push(Record{static_cast<long long>(i), {}});
+                }
+                while (!q.empty()) {
+                    q.pop();
+                }
+            });
+        }
+        for (size_t group : {4096, 256, 16, 1}) {
+            std::filesystem::remove_all(dir);
+            WalQueue<Record> q(dir, group);
+            size_t ops = group == 1 ? n / 100 : n;
+            bench::measure(prefix + " WalQueue group_commit=" + std::to_string(group), ops, [&] {
+                for (size_t i = 0; i < ops; ++i) {
+                    q.push(Record{static_cast<long long>(i), {}});
+                }
+                while (!q.empty()) {
+                    q.pop();
+                }
+                q.commit();
+            });
+        }
+        bench::measure(prefix + " WalQueue recovery", n, [&] {
+            std::filesystem::remove_all(dir);
+            {
+                WalQueue<Record> q(dir, 4096);
+                for (size_t i = 0; i < n; ++i) {
+                    q.push(Record{static_cast<long long>(i), {}});
+                }
+            }
+            WalQueue<Record> q(dir);
+            bench::do_not_optimize(q.size());
+        });
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
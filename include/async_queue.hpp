@@ -0,0 +1,250 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+#include "queue.hpp"
+
+// GCC (-Wmismatched-new-delete) считает обычный operator delete непарным
+// шаблонному operator new класса и предупреждает в каждой корутине с
+// allocator_arg; pragma вокруг promise_type не помогает - предупреждение
+// выдаётся в месте корутины. Встроенный operator new оставляет в кадре
+// вызов allocate_frame, и ложного предупреждения нет.
+#if defined(__GNUC__) || defined(__clang__)
+#define ASYNC_TASK_FRAME_NEW __attribute__((always_inline)) inline
+#else
+#define ASYNC_TASK_FRAME_NEW inline
+#endif
+
+// Корутина-задача, которая запускается сразу и освобождает кадр в деструкторе
+// владельца. Кадр выделяется из memory_resource, переданного после
+// std::allocator_arg (у методов — вторым после объекта), иначе из ресурса по
+// умолчанию.
+class AsyncTask {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+
+        // Ресурс и полный размер лежат перед кадром, чтобы operator delete,
+        // не получающий ни размер, ни аргументы корутины, мог вернуть блок
+        struct FrameHeader {
+            std::pmr::memory_resource* mr;
+            size_t size;
+        };
+
+        static constexpr size_t frame_header_size = 
+            (sizeof(FrameHeader) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        static void* allocate_frame(size_t size, std::pmr::memory_resource* mr) {
+            size_t total = frame_header_size + size;
+            void* block = mr->allocate(total, alignof(std::max_align_t));
+            ::new (block) FrameHeader{mr, total};
+            return static_cast<char*>(block) + frame_header_size;
+        }
+
+        static void free_frame(void* frame) {
+            void* block = static_cast<char*>(frame) - frame_header_size;
+            FrameHeader header = *static_cast<FrameHeader*>(block);
+            header.mr->deallocate(block, header.size, alignof(std::max_align_t));
+        }
+
+        static void* operator new(size_t size) {
+            return allocate_frame(size, std::pmr::get_default_resource());
+        }
+
+        template<typename... Args>
+        ASYNC_TASK_FRAME_NEW static void* operator new(size_t size, std::allocator_arg_t, std::pmr::memory_resource* mr, Args&&...) {
+            return allocate_frame(size, mr);
+        }
+
+        template<typename Self, typename... Args>
+        ASYNC_TASK_FRAME_NEW static void* operator new(size_t size, Self&, std::allocator_arg_t, std::pmr::memory_resource* mr, Args&&...) {
+            return allocate_frame(size, mr);
+        }
+
+        static void operator delete(void* frame) {
+            free_frame(frame);
+        }
+
+        AsyncTask get_return_object() {
+            return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            error = std::current_exception();
+        }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+public:
+    explicit AsyncTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    AsyncTask(AsyncTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    AsyncTask(const AsyncTask&) = delete;
+
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    ~AsyncTask() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool done() const {
+        return handle && handle.done();
+    }
+
+    // Пробрасывает исключение, которым завершилась корутина.
+    void get() const {
+        if (handle && handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+};
+
+// Однопоточная очередь для цикла событий: co_await pop_async() на пустой
+// очереди приостанавливает корутину, а push передаёт элемент ровно одному
+// ожидающему (в порядке ожидания) и возобновляет его сразу или через executor.
+template<typename T>
+class AsyncQueue {
+public:
+    using executor_type = std::function<void(std::coroutine_handle<>)>;
+
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        std::optional<T> slot;
+        Waiter* next = nullptr;
+        bool queued = false;
+    };
+
+    Queue<T> queue;
+    Waiter* waiters_head;
+    Waiter* waiters_tail;
+    executor_type executor;
+
+    void unlink_waiter(Waiter* waiter) {
+        Waiter* prev = nullptr;
+        for (Waiter* current = waiters_head; current; prev = current, current = current->next) {
+            if (current != waiter) {
+                continue;
+            }
+            if (prev) {
+                prev->next = current->next;
+            } else {
+                waiters_head = current->next;
+            }
+            if (waiters_tail == current) {
+                waiters_tail = prev;
+            }
+            return;
+        }
+    }
+
+public:
+    class PopAwaiter {
+    private:
+        AsyncQueue& owner;
+        Waiter waiter;
+
+    public:
+        explicit PopAwaiter(AsyncQueue& q) : owner(q) {}
+
+        PopAwaiter(const PopAwaiter&) = delete;
+        PopAwaiter& operator=(const PopAwaiter&) = delete;
+
+        // Корутину уничтожили, пока она ждала: ожидающий не должен остаться
+        // в списке, иначе следующий push возобновит освобождённый кадр
+        ~PopAwaiter() {
+            if (waiter.queued) {
+                owner.unlink_waiter(&waiter);
+            }
+        }
+
+        bool await_ready() const {
+            return !owner.queue.empty();
+        }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            waiter.handle = h;
+            waiter.queued = true;
+            if (owner.waiters_tail) {
+                owner.waiters_tail->next = &waiter;
+            } else {
+                owner.waiters_head = &waiter;
+            }
+            owner.waiters_tail = &waiter;
+        }
+
+        T await_resume() {
+            if (waiter.slot) {
+                return std::move(*waiter.slot);
+            }
+            T value = std::move(owner.queue.front());
+            owner.queue.pop();
+            return value;
+        }
+    };
+
+    explicit AsyncQueue(std::pmr::memory_resource* mr = std::pmr::get_default_resource(), 
+                        executor_type exec = nullptr)
+        : queue(mr), waiters_head(nullptr), waiters_tail(nullptr), executor(std::move(exec)) {}
+
+    AsyncQueue(const AsyncQueue&) = delete;
+
+    AsyncQueue& operator=(const AsyncQueue&) = delete;
+
+    PopAwaiter pop_async() {
+        return PopAwaiter(*this);
+    }
+
+    void push(T value) {
+        if (!waiters_head) {
+            queue.push(std::move(value));
+            return;
+        }
+        
+        Waiter* waiter = waiters_head;
+        waiters_head = waiter->next;
+        if (!waiters_head) {
+            waiters_tail = nullptr;
+        }
+        waiter->queued = false;
+        waiter->slot.emplace(std::move(value));
+        if (executor) {
+            executor(waiter->handle);
+        } else {
+            waiter->handle.resume();
+        }
+    }
+
+    bool empty() const {
+        return queue.empty();
+    }
+
+    size_t size() const {
+        return queue.size();
+    }
+
+    bool has_waiters() const {
+        return waiters_head != nullptr;
+    }
+};
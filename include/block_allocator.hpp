@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Невиртуальный собрат BlockMemoryResource: блоки одного размерного класса
+// (кратного 16 байтам, до max_small_size) переиспользуются через списки
+// свободных блоков, новые нарезаются из крупных кусков. Все вызовы видны
+// компилятору и встраиваются.
+class BlockPool {
+public:
+    static constexpr size_t granularity = alignof(std::max_align_t);
+    static constexpr size_t max_small_size = 512;
+    static constexpr size_t chunk_size = 64 * 1024;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t class_count = max_small_size / granularity;
+
+    FreeBlock* free_lists[class_count] = {};
+    std::vector<void*> chunks;
+    char* chunk_cursor = nullptr;
+    char* chunk_end = nullptr;
+
+    static size_t class_of(size_t bytes) {
+        return bytes ? (bytes - 1) / granularity : 0;
+    }
+
+    void* carve(size_t block_size) {
+        if (static_cast<size_t>(chunk_end - chunk_cursor) < block_size) {
+            void* chunk = ::operator new(chunk_size);
+            chunks.push_back(chunk);
+            chunk_cursor = static_cast<char*>(chunk);
+            chunk_end = chunk_cursor + chunk_size;
+        }
+        void* result = chunk_cursor;
+        chunk_cursor += block_size;
+        return result;
+    }
+
+public:
+    BlockPool() = default;
+
+    ~BlockPool() {
+        for (void* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    BlockPool(const BlockPool&) = delete;
+
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment) {
+        if (bytes > max_small_size || alignment > granularity) {
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+        size_t index = class_of(bytes);
+        if (FreeBlock* block = free_lists[index]) {
+            free_lists[index] = block->next;
+            return block;
+        }
+        return carve((index + 1) * granularity);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment) {
+        if (bytes > max_small_size || alignment > granularity) {
+            ::operator delete(p, std::align_val_t(alignment));
+            return;
+        }
+        size_t index = class_of(bytes);
+        free_lists[index] = ::new (p) FreeBlock{free_lists[index]};
+    }
+};
+
+template<typename T>
+class BlockAllocator {
+private:
+    BlockPool* pool;
+
+    template<typename U>
+    friend class BlockAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    explicit BlockAllocator(BlockPool& p) noexcept : pool(&p) {}
+
+    template<typename U>
+    BlockAllocator(const BlockAllocator<U>& other) noexcept : pool(other.pool) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(pool->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        pool->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    BlockPool* get_pool() const noexcept {
+        return pool;
+    }
+
+    template<typename U>
+    bool operator==(const BlockAllocator<U>& other) const noexcept {
+        return pool == other.pool;
+    }
+};
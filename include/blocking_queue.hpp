@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include "queue.hpp"
+
+// Потокобезопасная обёртка над Queue<T> с пакетным потреблением.
+// Размер пакета подстраивается под нагрузку: при накопившейся очереди он
+// растёт вдвое (до max_items), а если очередь опустела или обработка пакета
+// заняла больше ненулевого max_wait, уменьшается, чтобы не копить задержку.
+template<typename T>
+class BlockingQueue {
+private:
+    Queue<T> queue;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    bool closed;
+    size_t batch_limit;
+
+    void adapt(size_t taken, size_t remaining, size_t max_items, 
+               std::chrono::nanoseconds elapsed, std::chrono::nanoseconds max_wait) {
+        if (max_wait.count() > 0 && elapsed > max_wait && taken > 1) {
+            batch_limit = std::max<size_t>(1, taken / 2);
+        } else if (remaining > 0) {
+            batch_limit = std::min(max_items, std::max<size_t>(1, batch_limit * 2));
+        } else if (taken < batch_limit) {
+            batch_limit = std::max<size_t>(1, (batch_limit + taken) / 2);
+        }
+    }
+
+public:
+    explicit BlockingQueue(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : queue(mr), closed(false), batch_limit(1) {}
+
+    BlockingQueue(const BlockingQueue&) = delete;
+
+    BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+    void push(T value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) {
+                throw std::runtime_error("Queue is closed");
+            }
+            queue.push(std::move(value));
+        }
+        not_empty.notify_one();
+    }
+
+    std::optional<T> try_pop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.try_pop();
+    }
+
+    template<typename Rep, typename Period>
+    std::optional<T> pop_for(std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait_for(lock, timeout, [this] { return closed || !queue.empty(); });
+        return queue.try_pop();
+    }
+
+    // Ждёт не дольше max_wait первого элемента, затем забирает пакет
+    // адаптивного размера и передаёт его в callback(std::span<T>) уже без
+    // блокировки. Возвращает число обработанных элементов (0 — таймаут или
+    // закрытая пустая очередь).
+    template<typename Rep, typename Period, typename Callback>
+    size_t consume(size_t max_items, std::chrono::duration<Rep, Period> max_wait, Callback&& callback) {
+        auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(max_wait);
+        std::vector<T> batch;
+        size_t remaining;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait_for(lock, wait, [this] { return closed || !queue.empty(); });
+            size_t take = std::min({std::max<size_t>(1, max_items), batch_limit, queue.size()});
+            batch.reserve(take);
+            while (batch.size() < take) {
+                batch.push_back(std::move(*queue.try_pop()));
+            }
+            remaining = queue.size();
+        }
+        if (batch.empty()) {
+            return 0;
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        callback(std::span<T>(batch));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        adapt(batch.size(), remaining, std::max<size_t>(1, max_items), 
+              std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), wait);
+        return batch.size();
+    }
+
+    // После закрытия push бросает исключение, а ожидающие потребители
+    // просыпаются и дочитывают остаток.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_empty.notify_all();
+    }
+
+    bool is_closed() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.empty();
+    }
+
+    size_t current_batch_limit() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return batch_limit;
+    }
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Очередь с рассылкой: каждый элемент хранится в одном узле, а у каждого
+// подписчика свой курсор чтения. Узел возвращается в memory_resource, когда
+// его прошёл самый медленный подписчик. В конце цепочки всегда стоит пустой
+// узел-страж, поэтому курсор догнавшего подписчика не требует обновления
+// при push.
+template<typename T>
+class BroadcastQueue {
+public:
+    using subscriber_id = size_t;
+
+    enum class LagPolicy {
+        Throw,
+        Disconnect
+    };
+
+private:
+    // Не QueueNode<T>: тот всегда конструирует data, а у стража значения нет,
+    // и T не обязан иметь конструктор по умолчанию. Кроме того, курсорам
+    // нужен номер узла, чтобы отставание и retained() считались за O(1).
+    struct Node {
+        union {
+            T data;
+        };
+        Node* next;
+        uint64_t sequence;
+
+        explicit Node(uint64_t seq) : next(nullptr), sequence(seq) {}
+
+        ~Node() {}
+    };
+
+    struct Cursor {
+        Node* node;
+        bool active;
+    };
+
+    using allocator_type = std::pmr::polymorphic_allocator<Node>;
+
+    allocator_type allocator;
+    Node* head;
+    Node* sentinel;
+    std::vector<Cursor> cursors;
+    size_t active_subscribers;
+    size_t max_lag;
+    LagPolicy policy;
+
+    Node* make_sentinel(uint64_t sequence) {
+        Node* node = allocator.allocate(1);
+        ::new (static_cast<void*>(node)) Node(sequence);
+        return node;
+    }
+
+    void free_node(Node* node, bool has_data) {
+        if (has_data) {
+            std::destroy_at(&node->data);
+        }
+        std::destroy_at(node);
+        allocator.deallocate(node, 1);
+    }
+
+    uint64_t slowest_position() const {
+        uint64_t slowest = sentinel->sequence;
+        for (const Cursor& cursor : cursors) {
+            if (cursor.active && cursor.node->sequence < slowest) {
+                slowest = cursor.node->sequence;
+            }
+        }
+        return slowest;
+    }
+
+    void reclaim() {
+        uint64_t slowest = slowest_position();
+        while (head != sentinel && head->sequence < slowest) {
+            Node* temp = head;
+            head = head->next;
+            free_node(temp, true);
+        }
+    }
+
+    Cursor& cursor_of(subscriber_id id) {
+        if (id >= cursors.size() || !cursors[id].active) {
+            throw std::invalid_argument("Unknown subscriber");
+        }
+        return cursors[id];
+    }
+
+    void disconnect_lagging() {
+        bool disconnected = false;
+        for (Cursor& cursor : cursors) {
+            if (cursor.active && sentinel->sequence - cursor.node->sequence > max_lag) {
+                cursor.active = false;
+                --active_subscribers;
+                disconnected = true;
+            }
+        }
+        if (disconnected) {
+            reclaim();
+        }
+    }
+
+public:
+    // max_lag == 0 снимает ограничение на отставание подписчиков.
+    explicit BroadcastQueue(std::pmr::memory_resource* mr = std::pmr::get_default_resource(), 
+                            size_t lag_limit = 0, LagPolicy lag_policy = LagPolicy::Throw)
+        : allocator(mr), head(nullptr), sentinel(nullptr), active_subscribers(0), 
+          max_lag(lag_limit), policy(lag_policy) {
+        head = sentinel = make_sentinel(0);
+    }
+
+    ~BroadcastQueue() {
+        while (head != sentinel) {
+            Node* temp = head;
+            head = head->next;
+            free_node(temp, true);
+        }
+        free_node(sentinel, false);
+    }
+
+    BroadcastQueue(const BroadcastQueue&) = delete;
+
+    BroadcastQueue& operator=(const BroadcastQueue&) = delete;
+
+    // Новый подписчик получает только элементы, добавленные после подписки.
+    subscriber_id subscribe() {
+        cursors.push_back(Cursor{sentinel, true});
+        ++active_subscribers;
+        return cursors.size() - 1;
+    }
+
+    void unsubscribe(subscriber_id id) {
+        cursor_of(id).active = false;
+        --active_subscribers;
+        reclaim();
+    }
+
+    bool is_subscribed(subscriber_id id) const {
+        return id < cursors.size() && cursors[id].active;
+    }
+
+    void push(T value) {
+        // При политике Throw элемент не добавляется, если подписчик упёрся в предел
+        if (max_lag && policy == LagPolicy::Throw && active_subscribers) {
+            if (sentinel->sequence + 1 - slowest_position() > max_lag) {
+                throw std::runtime_error("Subscriber lag limit exceeded");
+            }
+        }
+        
+        Node* next_sentinel = make_sentinel(sentinel->sequence + 1);
+        try {
+            ::new (static_cast<void*>(&sentinel->data)) T(std::move(value));
+        } catch (...) {
+            free_node(next_sentinel, false);
+            throw;
+        }
+        sentinel->next = next_sentinel;
+        sentinel = next_sentinel;
+        
+        if (!active_subscribers) {
+            reclaim();
+        } else if (max_lag && policy == LagPolicy::Disconnect) {
+            disconnect_lagging();
+        }
+    }
+
+    const T* try_front(subscriber_id id) {
+        Cursor& cursor = cursor_of(id);
+        return cursor.node == sentinel ? nullptr : &cursor.node->data;
+    }
+
+    const T& front(subscriber_id id) {
+        const T* value = try_front(id);
+        if (!value) {
+            throw std::runtime_error("Queue is empty");
+        }
+        return *value;
+    }
+
+    void pop(subscriber_id id) {
+        Cursor& cursor = cursor_of(id);
+        if (cursor.node == sentinel) {
+            throw std::runtime_error("Queue is empty");
+        }
+        bool was_slowest = cursor.node == head;
+        cursor.node = cursor.node->next;
+        if (was_slowest) {
+            reclaim();
+        }
+    }
+
+    size_t lag(subscriber_id id) {
+        return static_cast<size_t>(sentinel->sequence - cursor_of(id).node->sequence);
+    }
+
+    size_t subscriber_count() const {
+        return active_subscribers;
+    }
+
+    // Число узлов, которые ещё нужны хотя бы одному подписчику.
+    size_t retained() const {
+        return static_cast<size_t>(sentinel->sequence - head->sequence);
+    }
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include "queue.hpp"
+
+// Очередь обновлений по ключам с правилом "последняя запись побеждает".
+// Пока обновление ключа стоит в очереди, новый push для того же ключа
+// заменяет значение прямо в узле и сохраняет его место в FIFO, так что
+// потребитель видит каждый ключ один раз и сразу в свежем состоянии.
+// Хеш-индекс хранит указатель на элемент в узле Queue (узлы не переезжают);
+// узлы и индекс берут память из одного memory_resource.
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class CoalescingQueue {
+public:
+    using value_type = std::pair<Key, T>;
+
+private:
+    Queue<value_type> queue;
+    std::pmr::unordered_map<Key, value_type*, Hash, KeyEqual> index;
+    size_t coalesced_count;
+
+public:
+    explicit CoalescingQueue(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : queue(mr), index(mr), coalesced_count(0) {}
+
+    // Указатели индекса привязаны к узлам этого объекта
+    CoalescingQueue(const CoalescingQueue&) = delete;
+    CoalescingQueue& operator=(const CoalescingQueue&) = delete;
+
+    // true - ключ встал в конец очереди, false - заменено значение уже
+    // стоящего в очереди ключа
+    bool push(const Key& key, T value) {
+        auto [it, inserted] = index.try_emplace(key, nullptr);
+        if (!inserted) {
+            it->second->second = std::move(value);
+            ++coalesced_count;
+            return false;
+        }
+        try {
+            queue.push(value_type(key, std::move(value)));
+        } catch (...) {
+            index.erase(it);
+            throw;
+        }
+        it->second = &queue.back();
+        return true;
+    }
+
+    value_type pop_value() {
+        if (queue.empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        index.erase(queue.front().first);
+        return queue.pop_value();
+    }
+
+    std::optional<value_type> try_pop() {
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        return pop_value();
+    }
+
+    const value_type& front() const {
+        if (queue.empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return *queue.begin();
+    }
+
+    // Ожидающее значение ключа или nullptr, если ключа в очереди нет
+    T* find(const Key& key) {
+        auto it = index.find(key);
+        return it == index.end() ? nullptr : &it->second->second;
+    }
+
+    const T* find(const Key& key) const {
+        auto it = index.find(key);
+        return it == index.end() ? nullptr : &it->second->second;
+    }
+
+    bool contains(const Key& key) const {
+        return index.find(key) != index.end();
+    }
+
+    void clear() {
+        index.clear();
+        queue.clear();
+    }
+
+    // Заранее растит индекс, чтобы push не перестраивал таблицу
+    void reserve(size_t keys) {
+        index.reserve(keys);
+    }
+
+    bool empty() const {
+        return queue.empty();
+    }
+
+    size_t size() const {
+        return queue.size();
+    }
+
+    // Сколько push было поглощено уже стоящими в очереди ключами
+    size_t coalesced() const {
+        return coalesced_count;
+    }
+
+    std::pmr::memory_resource* get_memory_resource() const {
+        return index.get_allocator().resource();
+    }
+};
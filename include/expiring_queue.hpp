@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include "queue.hpp"
+
+// Потокобезопасная очередь, в которой у каждого элемента есть срок годности.
+// Просроченные элементы не отдаются потребителю: pop и front снимают их с
+// головы пачкой, а необязательный фоновый поток раз в interval вычищает
+// просрочку по всей очереди через Queue::erase_if. Счётчики показывают,
+// сколько элементов выброшено каждым из путей.
+template<typename T>
+class ExpiringQueue {
+public:
+    using clock = std::chrono::steady_clock;
+    using time_point = clock::time_point;
+
+    struct ExpiryStats {
+        size_t expired_at_head = 0;
+        size_t expired_by_reaper = 0;
+
+        size_t total() const {
+            return expired_at_head + expired_by_reaper;
+        }
+    };
+
+private:
+    struct Entry {
+        T value;
+        time_point deadline;
+    };
+
+    Queue<Entry> queue;
+    mutable std::mutex mutex;
+    ExpiryStats counters;
+
+    std::thread reaper;
+    std::condition_variable reaper_wakeup;
+    bool reaper_stop;
+
+    // Вызывается под мьютексом
+    void drop_expired_front(time_point now) {
+        while (!queue.empty() && queue.front().deadline <= now) {
+            queue.pop();
+            ++counters.expired_at_head;
+        }
+    }
+
+    size_t reap_locked(time_point now) {
+        size_t erased = queue.erase_if([now](const Entry& e) { return e.deadline <= now; });
+        counters.expired_by_reaper += erased;
+        return erased;
+    }
+
+public:
+    explicit ExpiringQueue(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : queue(mr), reaper_stop(false) {}
+
+    ExpiringQueue(const ExpiringQueue&) = delete;
+    ExpiringQueue& operator=(const ExpiringQueue&) = delete;
+
+    ~ExpiringQueue() {
+        stop_reaper();
+    }
+
+    void push(T value, time_point deadline) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push(Entry{std::move(value), deadline});
+    }
+
+    template<typename Rep, typename Period>
+    void push_for(T value, std::chrono::duration<Rep, Period> ttl) {
+        push(std::move(value), clock::now() + std::chrono::duration_cast<clock::duration>(ttl));
+    }
+
+    // Первый непросроченный элемент; просроченные перед ним выбрасываются
+    std::optional<T> try_pop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        drop_expired_front(clock::now());
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        return std::optional<T>(std::move(queue.pop_value().value));
+    }
+
+    // Копия первого непросроченного элемента без извлечения
+    std::optional<T> try_front() {
+        std::lock_guard<std::mutex> lock(mutex);
+        drop_expired_front(clock::now());
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        return queue.front().value;
+    }
+
+    // Полная чистка просрочки по всей очереди; возвращает число удалённых
+    size_t reap() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reap_locked(clock::now());
+    }
+
+    // Фоновая чистка раз в interval; повторный вызов меняет интервал
+    template<typename Rep, typename Period>
+    void start_reaper(std::chrono::duration<Rep, Period> interval) {
+        stop_reaper();
+        auto period = std::chrono::duration_cast<clock::duration>(interval);
+        reaper_stop = false;
+        reaper = std::thread([this, period] {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!reaper_wakeup.wait_for(lock, period, [this] { return reaper_stop; })) {
+                reap_locked(clock::now());
+            }
+        });
+    }
+
+    void stop_reaper() {
+        if (!reaper.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            reaper_stop = true;
+        }
+        reaper_wakeup.notify_all();
+        reaper.join();
+    }
+
+    bool reaper_running() const {
+        return reaper.joinable();
+    }
+
+    // Включая ещё не вычищенные просроченные элементы
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    ExpiryStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+};
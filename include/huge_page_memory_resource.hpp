@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Монотонный ресурс поверх анонимных отображений, выровненных на 2 МБ.
+// Каждый кусок помечается MADV_HUGEPAGE, чтобы ядро подложило прозрачные
+// huge pages, и привязывается к NUMA-узлу вызывающего потока через mbind.
+// Освобождение отдельных блоков ничего не делает: память возвращается целиком
+// в release() или в деструкторе. Для переиспользования узлов ресурс ставится
+// upstream-ом под BlockMemoryResource. Если huge pages или NUMA недоступны,
+// ресурс молча работает на обычных страницах.
+class HugePageMemoryResource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t huge_page_size = size_t(2) << 20;
+    static constexpr size_t default_chunk_size = size_t(32) << 20;
+
+    struct Options {
+        size_t chunk_size = default_chunk_size;
+        bool huge_pages = true;
+        bool bind_to_local_node = true;
+    };
+
+private:
+    struct Chunk {
+        char* base;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t chunk_size;
+    bool use_huge_pages;
+    int node = -1;
+    bool huge_pages_applied = false;
+    bool node_bound = false;
+
+    static size_t round_up(size_t value, size_t to) {
+        return (value + to - 1) / to * to;
+    }
+
+    // Узел текущего CPU; -1, если машина однопроцессорная по NUMA или
+    // ядро не отдаёт номер узла
+    static int local_numa_node() {
+#if defined(__linux__) && defined(SYS_getcpu) && defined(SYS_mbind)
+        if (access("/sys/devices/system/node/node1", F_OK) != 0) {
+            return -1;
+        }
+        unsigned cpu = 0;
+        unsigned numa = 0;
+        if (syscall(SYS_getcpu, &cpu, &numa, nullptr) != 0) {
+            return -1;
+        }
+        return static_cast<int>(numa);
+#else
+        return -1;
+#endif
+    }
+
+    bool bind_to_node(char* base, size_t size) const {
+#if defined(__linux__) && defined(SYS_mbind)
+        constexpr int mpol_preferred = 1;
+        constexpr size_t mask_bits = sizeof(unsigned long) * 8;
+        if (node < 0 || static_cast<size_t>(node) >= mask_bits) {
+            return false;
+        }
+        unsigned long mask = 1UL << node;
+        return syscall(SYS_mbind, base, size, mpol_preferred, &mask, mask_bits + 1, 0) == 0;
+#else
+        (void)base;
+        (void)size;
+        return false;
+#endif
+    }
+
+    // Отображаем с запасом и обрезаем края, чтобы начало куска легло
+    // на границу huge page
+    Chunk map_chunk(size_t size) {
+        size_t reserve = size + huge_page_size;
+        void* raw = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char* start = static_cast<char*>(raw);
+        char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(start), huge_page_size));
+        if (aligned != start) {
+            munmap(start, static_cast<size_t>(aligned - start));
+        }
+        char* end = start + reserve;
+        if (aligned + size != end) {
+            munmap(aligned + size, static_cast<size_t>(end - (aligned + size)));
+        }
+
+#ifdef MADV_HUGEPAGE
+        if (use_huge_pages) {
+            huge_pages_applied = madvise(aligned, size, MADV_HUGEPAGE) == 0 || huge_pages_applied;
+        }
+#endif
+#ifdef MADV_NOHUGEPAGE
+        if (!use_huge_pages) {
+            madvise(aligned, size, MADV_NOHUGEPAGE);
+        }
+#endif
+        if (bind_to_node(aligned, size)) {
+            node_bound = true;
+        }
+        return {aligned, size};
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        char* p = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(cursor), alignment));
+        if (cursor == nullptr || p + bytes > limit) {
+            size_t size = round_up(std::max(chunk_size, bytes + alignment), huge_page_size);
+            Chunk chunk = map_chunk(size);
+            chunks.push_back(chunk);
+            cursor = chunk.base;
+            limit = chunk.base + chunk.size;
+            p = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(cursor), alignment));
+        }
+        cursor = p + bytes;
+        return p;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    HugePageMemoryResource() : HugePageMemoryResource(Options{}) {}
+
+    explicit HugePageMemoryResource(Options options)
+        : chunk_size(round_up(options.chunk_size ? options.chunk_size : huge_page_size, huge_page_size)),
+          use_huge_pages(options.huge_pages),
+          node(options.bind_to_local_node ? local_numa_node() : -1) {}
+
+    HugePageMemoryResource(const HugePageMemoryResource&) = delete;
+    HugePageMemoryResource& operator=(const HugePageMemoryResource&) = delete;
+
+    ~HugePageMemoryResource() override {
+        release();
+    }
+
+    void release() {
+        for (const Chunk& chunk : chunks) {
+            munmap(chunk.base, chunk.size);
+        }
+        chunks.clear();
+        cursor = nullptr;
+        limit = nullptr;
+    }
+
+    size_t mapped_bytes() const {
+        size_t total = 0;
+        for (const Chunk& chunk : chunks) {
+            total += chunk.size;
+        }
+        return total;
+    }
+
+    size_t chunk_count() const {
+        return chunks.size();
+    }
+
+    // true, если ядро приняло MADV_HUGEPAGE хотя бы для одного куска
+    bool huge_pages_enabled() const {
+        return huge_pages_applied;
+    }
+
+    // Узел, к которому привязываются куски, или -1 без NUMA
+    int numa_node() const {
+        return node;
+    }
+
+    bool numa_bound() const {
+        return node_bound;
+    }
+};
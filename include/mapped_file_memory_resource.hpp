@@ -0,0 +1,290 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Ресурс памяти поверх отображённого в память файла. Все служебные ссылки
+// внутри файла хранятся как смещения от начала отображения, поэтому файл
+// можно открыть заново по другому адресу. Блоки освобождаются в список
+// свободных и переиспользуются первым подходящим, как в BlockMemoryResource.
+class MappedFileMemoryResource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t root_size = 128;
+    static constexpr size_t max_alignment = alignof(std::max_align_t);
+
+    enum class SyncMode {
+        Sync,
+        Async
+    };
+
+    // OpenOrCreate решает по размеру файла, что подходит одному процессу.
+    // Когда файл открывают несколько процессов, создатель определяется
+    // снаружи (например, O_EXCL), а подключающийся ждёт, пока создатель
+    // задаст размер и опубликует заголовок, и никогда его не пишет.
+    enum class OpenMode {
+        OpenOrCreate,
+        Create,
+        Attach
+    };
+
+    // Сколько Attach ждёт заголовка, прежде чем считать создателя умершим
+    static constexpr std::chrono::seconds attach_timeout{5};
+
+private:
+    static constexpr uint64_t file_magic = 0x4d51424c4b4d5246ULL;
+    // 2: выданные блоки помечены allocated_marker
+    static constexpr uint32_t file_version = 2;
+
+    struct FileHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t capacity;
+        uint64_t bump;
+        uint64_t free_list;
+        alignas(max_alignment) unsigned char root[root_size];
+    };
+
+    struct Block {
+        uint64_t size;
+        uint64_t next_free;
+    };
+
+    // next_free выданного блока; у последнего свободного блока там 0
+    static constexpr uint64_t allocated_marker = ~uint64_t(0);
+
+    static_assert(sizeof(Block) % max_alignment == 0);
+
+    int fd;
+    char* base;
+    size_t mapped_size;
+    bool created_;
+
+    FileHeader* header() const {
+        return reinterpret_cast<FileHeader*>(base);
+    }
+
+    Block* block_at(uint64_t offset) const {
+        return reinterpret_cast<Block*>(base + offset);
+    }
+
+    static size_t round_up(size_t value) {
+        return (value + max_alignment - 1) & ~(max_alignment - 1);
+    }
+
+    [[noreturn]] static void throw_errno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    // Ждёт, пока создатель задаст размер файла
+    size_t wait_for_size() {
+        auto deadline = std::chrono::steady_clock::now() + attach_timeout;
+        for (;;) {
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                throw_errno("fstat");
+            }
+            if (st.st_size > 0) {
+                return static_cast<size_t>(st.st_size);
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                throw std::runtime_error("Mapped file was not initialised in time");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // magic пишется последним, после него заголовок можно читать
+    bool header_published() const {
+        return std::atomic_ref<uint64_t>(header()->magic).load(std::memory_order_acquire) == file_magic;
+    }
+
+    void map(size_t capacity, OpenMode mode) {
+        if (mode == OpenMode::Attach) {
+            mapped_size = wait_for_size();
+            created_ = false;
+        } else {
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                throw_errno("fstat");
+            }
+            created_ = st.st_size == 0;
+            if (mode == OpenMode::Create && !created_) {
+                throw std::runtime_error("Mapped file already exists");
+            }
+            mapped_size = static_cast<size_t>(st.st_size);
+        }
+        if (created_) {
+            if (capacity < round_up(sizeof(FileHeader)) + sizeof(Block)) {
+                throw std::invalid_argument("Mapped file capacity is too small");
+            }
+            if (ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+                throw_errno("ftruncate");
+            }
+            mapped_size = capacity;
+        }
+
+        void* p = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            throw_errno("mmap");
+        }
+        base = static_cast<char*>(p);
+
+        if (created_) {
+            FileHeader* h = header();
+            h->version = file_version;
+            h->reserved = 0;
+            h->capacity = mapped_size;
+            h->bump = round_up(sizeof(FileHeader));
+            h->free_list = 0;
+            for (auto& byte : h->root) {
+                byte = 0;
+            }
+            std::atomic_ref<uint64_t>(h->magic).store(file_magic, std::memory_order_release);
+            return;
+        }
+        if (mode == OpenMode::Attach && mapped_size >= sizeof(FileHeader)) {
+            auto deadline = std::chrono::steady_clock::now() + attach_timeout;
+            while (!header_published() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        if (mapped_size < sizeof(FileHeader) || !header_published() ||
+            header()->version != file_version || header()->capacity != mapped_size) {
+            munmap(base, mapped_size);
+            throw std::runtime_error("Mapped file has unknown format");
+        }
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (alignment > max_alignment) {
+            throw std::invalid_argument("Unsupported alignment for mapped file");
+        }
+        bytes = round_up(bytes ? bytes : 1);
+        FileHeader* h = header();
+
+        uint64_t* link = &h->free_list;
+        while (*link) {
+            Block* block = block_at(*link);
+            if (block->size >= bytes) {
+                uint64_t offset = *link;
+                *link = block->next_free;
+                block->next_free = allocated_marker;
+                return base + offset + sizeof(Block);
+            }
+            link = &block->next_free;
+        }
+
+        if (h->bump + sizeof(Block) + bytes > h->capacity) {
+            throw std::bad_alloc();
+        }
+        uint64_t offset = h->bump;
+        Block* block = block_at(offset);
+        block->size = bytes;
+        block->next_free = allocated_marker;
+        h->bump = offset + sizeof(Block) + bytes;
+        return base + offset + sizeof(Block);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        (void)bytes;
+        (void)alignment;
+        char* c = static_cast<char*>(p);
+        if (c < base + round_up(sizeof(FileHeader)) + sizeof(Block) || c >= base + header()->bump) {
+            throw std::invalid_argument("Attempt to deallocate unknown block");
+        }
+        uint64_t offset = static_cast<uint64_t>(c - base) - sizeof(Block);
+        Block* block = block_at(offset);
+        // Повторное освобождение зациклило бы список свободных
+        if (block->next_free != allocated_marker) {
+            throw std::invalid_argument("Attempt to deallocate a block twice");
+        }
+        block->next_free = header()->free_list;
+        header()->free_list = offset;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    // Открывает существующий файл или создаёт новый заданной ёмкости.
+    MappedFileMemoryResource(const std::string& path, size_t capacity) 
+        : fd(-1), base(nullptr), mapped_size(0), created_(false) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw_errno("open");
+        }
+        try {
+            map(capacity, OpenMode::OpenOrCreate);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    // Принимает во владение уже открытый дескриптор (например, от shm_open).
+    // При Attach capacity не используется.
+    MappedFileMemoryResource(int file_descriptor, size_t capacity, OpenMode mode)
+        : fd(file_descriptor), base(nullptr), mapped_size(0), created_(false) {
+        try {
+            map(capacity, mode);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    ~MappedFileMemoryResource() override {
+        munmap(base, mapped_size);
+        ::close(fd);
+    }
+
+    MappedFileMemoryResource(const MappedFileMemoryResource&) = delete;
+
+    MappedFileMemoryResource& operator=(const MappedFileMemoryResource&) = delete;
+
+    bool created() const {
+        return created_;
+    }
+
+    size_t capacity() const {
+        return mapped_size;
+    }
+
+    size_t used() const {
+        return header()->bump;
+    }
+
+    // Область фиксированного размера для корня пользовательской структуры.
+    void* root() const {
+        return header()->root;
+    }
+
+    uint64_t offset_of(const void* p) const {
+        return p ? static_cast<uint64_t>(static_cast<const char*>(p) - base) : 0;
+    }
+
+    void* pointer_at(uint64_t offset) const {
+        return offset ? base + offset : nullptr;
+    }
+
+    void sync(SyncMode mode = SyncMode::Sync) {
+        if (msync(base, mapped_size, mode == SyncMode::Sync ? MS_SYNC : MS_ASYNC) != 0) {
+            throw_errno("msync");
+        }
+    }
+};
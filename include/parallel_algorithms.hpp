@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "queue.hpp"
+#include "thread_pool.hpp"
+
+// Алгоритмы работают по сегментам, размеченным Queue::enable_segments.
+// Без разметки вся очередь обрабатывается одной задачей.
+// Очередь не должна изменяться, пока алгоритм выполняется.
+
+template<typename T, typename Alloc>
+std::vector<std::pair<QueueIterator<T>, QueueIterator<T>>> 
+partition_queue(Queue<T, Alloc>& queue, size_t max_chunks) {
+    auto segments = queue.segments();
+    if (segments.size() <= max_chunks || max_chunks == 0) {
+        return segments;
+    }
+    
+    std::vector<std::pair<QueueIterator<T>, QueueIterator<T>>> chunks;
+    chunks.reserve(max_chunks);
+    size_t per_chunk = (segments.size() + max_chunks - 1) / max_chunks;
+    for (size_t i = 0; i < segments.size(); i += per_chunk) {
+        size_t last = std::min(i + per_chunk, segments.size()) - 1;
+        chunks.emplace_back(segments[i].first, segments[last].second);
+    }
+    return chunks;
+}
+
+inline size_t parallel_chunk_limit(const ThreadPool& pool) {
+    return pool.size() * 4;
+}
+
+// Задачи ссылаются на локальные объекты вызывающего, поэтому перед get()
+// (который может бросить исключение) дожидаемся завершения всех задач.
+template<typename R>
+void wait_all(std::vector<std::future<R>>& pending) {
+    for (auto& result : pending) {
+        result.wait();
+    }
+}
+
+template<typename T, typename Alloc, typename F>
+void parallel_for_each(Queue<T, Alloc>& queue, ThreadPool& pool, F f) {
+    auto chunks = partition_queue(queue, parallel_chunk_limit(pool));
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks.size());
+    for (auto& chunk : chunks) {
+        pending.push_back(pool.submit([chunk, &f] {
+            std::for_each(chunk.first, chunk.second, f);
+        }));
+    }
+    wait_all(pending);
+    for (auto& result : pending) {
+        result.get();
+    }
+}
+
+template<typename T, typename Alloc, typename R, typename Reduce, typename Transform>
+R parallel_transform_reduce(Queue<T, Alloc>& queue, ThreadPool& pool, R init, 
+                            Reduce reduce, Transform transform) {
+    auto chunks = partition_queue(queue, parallel_chunk_limit(pool));
+    std::vector<std::future<R>> pending;
+    pending.reserve(chunks.size());
+    for (auto& chunk : chunks) {
+        pending.push_back(pool.submit([chunk, &reduce, &transform] {
+            auto it = chunk.first;
+            R partial = transform(*it);
+            for (++it; it != chunk.second; ++it) {
+                partial = reduce(std::move(partial), transform(*it));
+            }
+            return partial;
+        }));
+    }
+    wait_all(pending);
+    for (auto& result : pending) {
+        init = reduce(std::move(init), result.get());
+    }
+    return init;
+}
+
+template<typename T, typename Alloc, typename R, typename Reduce = std::plus<>>
+R parallel_reduce(Queue<T, Alloc>& queue, ThreadPool& pool, R init, Reduce reduce = Reduce()) {
+    return parallel_transform_reduce(queue, pool, std::move(init), reduce, 
+                                     [](const T& value) -> const T& { return value; });
+}
+
+// Возвращает первый в порядке очереди элемент, удовлетворяющий предикату.
+// Сегменты позади уже найденного совпадения прекращают поиск досрочно.
+template<typename T, typename Alloc, typename Predicate>
+QueueIterator<T> parallel_find_if(Queue<T, Alloc>& queue, ThreadPool& pool, Predicate pred) {
+    auto chunks = partition_queue(queue, parallel_chunk_limit(pool));
+    std::atomic<size_t> best(std::numeric_limits<size_t>::max());
+    std::vector<std::future<std::optional<QueueIterator<T>>>> pending;
+    pending.reserve(chunks.size());
+    for (size_t index = 0; index < chunks.size(); ++index) {
+        pending.push_back(pool.submit([&chunks, &best, &pred, index]() -> std::optional<QueueIterator<T>> {
+            for (auto it = chunks[index].first; it != chunks[index].second; ++it) {
+                if (best.load(std::memory_order_relaxed) < index) {
+                    return std::nullopt;
+                }
+                if (pred(*it)) {
+                    size_t current = best.load(std::memory_order_relaxed);
+                    while (index < current && 
+                           !best.compare_exchange_weak(current, index, std::memory_order_relaxed)) {
+                    }
+                    return it;
+                }
+            }
+            return std::nullopt;
+        }));
+    }
+    
+    wait_all(pending);
+    std::vector<std::optional<QueueIterator<T>>> found;
+    found.reserve(pending.size());
+    for (auto& result : pending) {
+        found.push_back(result.get());
+    }
+    for (auto& candidate : found) {
+        if (candidate) {
+            return *candidate;
+        }
+    }
+    return queue.end();
+}
+
+template<typename T, typename Alloc, typename U>
+QueueIterator<T> parallel_find(Queue<T, Alloc>& queue, ThreadPool& pool, const U& value) {
+    return parallel_find_if(queue, pool, [&value](const T& element) { return element == value; });
+}
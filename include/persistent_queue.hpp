@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "mapped_file_memory_resource.hpp"
+
+// sequence - номер узла в цепочке (у следующего на единицу больше), по
+// нему размер восстанавливается без прохода от головы до хвоста
+template<typename T>
+struct PersistentQueueNode {
+    T data;
+    uint64_t next;
+    uint64_t sequence;
+};
+
+template<typename T>
+class PersistentQueueIterator {
+private:
+    const MappedFileMemoryResource* mr;
+    uint64_t current;
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    PersistentQueueIterator(const MappedFileMemoryResource* resource = nullptr, uint64_t offset = 0) 
+        : mr(resource), current(offset) {}
+
+    reference operator*() const { 
+        return static_cast<PersistentQueueNode<T>*>(mr->pointer_at(current))->data; 
+    }
+    
+    pointer operator->() const { 
+        return &**this; 
+    }
+
+    PersistentQueueIterator& operator++() {
+        if (current) {
+            current = static_cast<PersistentQueueNode<T>*>(mr->pointer_at(current))->next;
+        }
+        return *this;
+    }
+
+    PersistentQueueIterator operator++(int) {
+        PersistentQueueIterator temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    bool operator==(const PersistentQueueIterator& other) const {
+        return current == other.current;
+    }
+
+    bool operator!=(const PersistentQueueIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+// Очередь, узлы которой живут в MappedFileMemoryResource и связаны смещениями.
+// Повторное открытие файла занимает O(1): голова, хвост и размер лежат в
+// корневой области ресурса, сами узлы подгружаются ОС по мере обращения.
+// Восстановление после сбоя трогает только узлы прерванной операции.
+template<typename T>
+class PersistentQueue {
+private:
+    static_assert(std::is_trivially_copyable_v<T>, "PersistentQueue requires trivially copyable T");
+
+    using node_type = PersistentQueueNode<T>;
+    using allocator_type = std::pmr::polymorphic_allocator<node_type>;
+
+    // "PQUEUE02": узлы с номером sequence
+    static constexpr uint64_t root_magic = 0x5051554555453032ULL;
+
+    struct Root {
+        uint64_t magic;
+        uint64_t node_size;
+        uint64_t head;
+        uint64_t tail;
+        uint64_t size;
+        // Узлы разных типов бывают одного размера, поэтому тип сверяется и по T
+        uint64_t value_size;
+        uint64_t value_alignment;
+    };
+
+    static_assert(sizeof(Root) <= MappedFileMemoryResource::root_size);
+
+    MappedFileMemoryResource& mr;
+    allocator_type allocator;
+    Root* root;
+    size_t sync_interval;
+    size_t unsynced;
+
+    node_type* node(uint64_t offset) const {
+        return static_cast<node_type*>(mr.pointer_at(offset));
+    }
+
+    // push сначала прицепляет узел (next хвоста или head), затем пишет tail
+    // и size; pop последнего узла обнуляет tail раньше head. Поэтому после
+    // сбоя хвост догоняется по ссылкам за tail (не дальше одного узла), а
+    // size считается по номерам головы и хвоста.
+    void recover() {
+        if (!root->head) {
+            root->tail = 0;
+        } else if (!root->tail) {
+            root->tail = root->head;
+        }
+        while (root->tail && node(root->tail)->next) {
+            root->tail = node(root->tail)->next;
+        }
+        root->size = root->head ? node(root->tail)->sequence - node(root->head)->sequence + 1 : 0;
+    }
+
+    void note_write() {
+        if (sync_interval && ++unsynced >= sync_interval) {
+            sync();
+        }
+    }
+
+public:
+    using iterator = PersistentQueueIterator<T>;
+
+    explicit PersistentQueue(MappedFileMemoryResource& resource, size_t sync_every = 0)
+        : mr(resource), allocator(&resource), 
+          root(static_cast<Root*>(resource.root())), 
+          sync_interval(sync_every), unsynced(0) {
+        if (root->magic == 0) {
+            root->node_size = sizeof(node_type);
+            root->head = 0;
+            root->tail = 0;
+            root->size = 0;
+            root->value_size = sizeof(T);
+            root->value_alignment = alignof(T);
+            root->magic = root_magic;
+        } else if (root->magic != root_magic || root->node_size != sizeof(node_type) ||
+                   root->value_size != sizeof(T) || root->value_alignment != alignof(T)) {
+            throw std::runtime_error("Mapped file holds a queue of another type");
+        }
+        recover();
+    }
+
+    PersistentQueue(const PersistentQueue&) = delete;
+
+    PersistentQueue& operator=(const PersistentQueue&) = delete;
+
+    void push(const T& value) {
+        node_type* new_node = allocator.allocate(1);
+        new_node->data = value;
+        new_node->next = 0;
+        new_node->sequence = root->tail ? node(root->tail)->sequence + 1 : 0;
+        
+        uint64_t offset = mr.offset_of(new_node);
+        if (root->tail) {
+            node(root->tail)->next = offset;
+        } else {
+            root->head = offset;
+        }
+        root->tail = offset;
+        ++root->size;
+        note_write();
+    }
+
+    void pop() {
+        if (empty()) {
+            throw std::runtime_error("Queue is empty");
+        }
+        
+        node_type* temp = node(root->head);
+        // Сбой между записями оставит узел в очереди, а не хвост на освобождённом узле
+        if (!temp->next) {
+            root->tail = 0;
+        }
+        root->head = temp->next;
+        --root->size;
+        
+        allocator.deallocate(temp, 1);
+        note_write();
+    }
+
+    T& front() {
+        if (empty()) {
+            throw std::runtime_error("Queue is empty");
+        }
+        return node(root->head)->data;
+    }
+    
+    T& back() {
+        if (empty()) {
+            throw std::runtime_error("Queue is empty");
+        }
+        return node(root->tail)->data;
+    }
+    
+    bool empty() const { 
+        return root->head == 0; 
+    }
+
+    size_t size() const { 
+        return root->size; 
+    }
+    
+    void clear() {
+        while (!empty()) {
+            pop();
+        }
+    }
+
+    // 0 — сбрасывать изменения на диск только явным вызовом sync().
+    void set_sync_interval(size_t operations) {
+        sync_interval = operations;
+    }
+
+    void sync(MappedFileMemoryResource::SyncMode mode = MappedFileMemoryResource::SyncMode::Sync) {
+        mr.sync(mode);
+        unsynced = 0;
+    }
+    
+    iterator begin() { 
+        return iterator(&mr, root->head); 
+    }
+
+    iterator end() { 
+        return iterator(&mr, 0); 
+    }
+};
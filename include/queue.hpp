@@ -1,40 +1,120 @@
+#pragma once
+
 #include <memory_resource>
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <iterator>
 #include <stdexcept>
-#include <memory_resource>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <compare>
+#include <type_traits>
+#include <optional>
+#include <span>
+
+// Трассировка выделений BlockMemoryResource собирается только в отладочных
+// сборках (или при явном BLOCK_MEMORY_RESOURCE_TRACING=1) и включается во
+// время работы вызовом enable_tracing(); в release остаются пустые методы.
+#ifndef BLOCK_MEMORY_RESOURCE_TRACING
+#ifdef NDEBUG
+#define BLOCK_MEMORY_RESOURCE_TRACING 0
+#else
+#define BLOCK_MEMORY_RESOURCE_TRACING 1
+#endif
+#endif
+
+#if BLOCK_MEMORY_RESOURCE_TRACING
+#include <chrono>
+#include <iostream>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+#else
+#include <iosfwd>
+#endif
 
 class BlockMemoryResource : public std::pmr::memory_resource {
 private:
     struct Block {
         void* ptr;
         size_t size;
+        size_t alignment;
         
-        Block(void* p, size_t s) : ptr(p), size(s) {}
+        Block(void* p, size_t s, size_t a) : ptr(p), size(s), alignment(a) {}
     };
     
+    std::pmr::memory_resource* upstream;
     std::vector<Block> allocated_blocks;
     std::vector<Block> free_blocks;
     
+#if BLOCK_MEMORY_RESOURCE_TRACING
+    struct TraceRecord {
+        size_t size;
+        size_t alignment;
+        std::chrono::steady_clock::time_point time;
+        const char* tag;
+    };
+    
+    bool tracing = false;
+    const char* current_tag = nullptr;
+    std::ostream* report_stream = &std::cerr;
+    std::unordered_map<void*, TraceRecord> live_blocks;
+    std::unordered_set<void*> released_blocks;
+    
+    void* trace_allocation(void* ptr, size_t bytes, size_t alignment) {
+        if (tracing) {
+            live_blocks[ptr] = TraceRecord{bytes, alignment, std::chrono::steady_clock::now(), current_tag};
+            released_blocks.erase(ptr);
+        }
+        return ptr;
+    }
+    
+    void trace_deallocation(void* p, size_t bytes, size_t alignment) {
+        if (!tracing) {
+            return;
+        }
+        auto it = live_blocks.find(p);
+        if (it == live_blocks.end()) {
+            if (released_blocks.count(p)) {
+                throw std::invalid_argument("Double free of block");
+            }
+            return;
+        }
+        if (it->second.size != bytes || it->second.alignment != alignment) {
+            throw std::invalid_argument("Deallocation size or alignment mismatch");
+        }
+        live_blocks.erase(it);
+        released_blocks.insert(p);
+    }
+#else
+    static void* trace_allocation(void* ptr, size_t, size_t) {
+        return ptr;
+    }
+    
+    static void trace_deallocation(void*, size_t, size_t) {}
+#endif
+    
     void* do_allocate(size_t bytes, size_t alignment) override {
         auto it = free_blocks.begin();
         while (it != free_blocks.end()) {
-            if (it->size >= bytes) {
+            if (it->size >= bytes && it->alignment >= alignment) {
                 void* result = it->ptr;
+                allocated_blocks.push_back(*it);
                 free_blocks.erase(it);
-                allocated_blocks.push_back(Block(result, bytes));                
-                return result;
+                return trace_allocation(result, bytes, alignment);
             }
             ++it;
         }
         
-        void* ptr = ::operator new(bytes);
-        allocated_blocks.push_back(Block(ptr, bytes));                
-        return ptr;
+        void* ptr = upstream->allocate(bytes, alignment);
+        allocated_blocks.push_back(Block(ptr, bytes, alignment));                
+        return trace_allocation(ptr, bytes, alignment);
     }
     
     void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        trace_deallocation(p, bytes, alignment);
         auto it = allocated_blocks.begin();
         while (it != allocated_blocks.end()) {
             if (it->ptr == p) {
@@ -53,16 +133,94 @@ private:
     }
     
 public:
+    // Новые блоки берутся у upstream и возвращаются ему только при
+    // разрушении ресурса; освобождённые блоки переиспользуются.
+    explicit BlockMemoryResource(std::pmr::memory_resource* upstream_mr = std::pmr::new_delete_resource())
+        : upstream(upstream_mr) {}
+    
     ~BlockMemoryResource() override {
+#if BLOCK_MEMORY_RESOURCE_TRACING
+        if (tracing && !live_blocks.empty() && report_stream) {
+            write_leak_report(*report_stream);
+        }
+#endif
         for (const auto& block : allocated_blocks) {
-            ::operator delete(block.ptr);
+            upstream->deallocate(block.ptr, block.size, block.alignment);
         }
         for (const auto& block : free_blocks) {
-            ::operator delete(block.ptr);
+            upstream->deallocate(block.ptr, block.size, block.alignment);
         }
     }
+    
+    BlockMemoryResource(const BlockMemoryResource&) = delete;
+    
+    BlockMemoryResource& operator=(const BlockMemoryResource&) = delete;
+    
+    std::pmr::memory_resource* upstream_resource() const {
+        return upstream;
+    }
+    
+#if BLOCK_MEMORY_RESOURCE_TRACING
+    // Отчёт об утечках пишется в report при разрушении ресурса; nullptr
+    // отключает автоматический отчёт.
+    void enable_tracing(bool enable = true, std::ostream* report = &std::cerr) {
+        tracing = enable;
+        report_stream = report;
+        if (!enable) {
+            live_blocks.clear();
+            released_blocks.clear();
+        }
+    }
+    
+    // Метка места вызова для последующих выделений; строка должна жить
+    // дольше ресурса (обычно литерал).
+    void set_allocation_tag(const char* tag) {
+        current_tag = tag;
+    }
+    
+    size_t live_allocation_count() const {
+        return live_blocks.size();
+    }
+    
+    void write_leak_report(std::ostream& out) const {
+        size_t total = 0;
+        for (const auto& [ptr, record] : live_blocks) {
+            total += record.size;
+        }
+        out << "BlockMemoryResource leak report: " << live_blocks.size() 
+            << " block(s), " << total << " byte(s)\n";
+        auto now = std::chrono::steady_clock::now();
+        for (const auto& [ptr, record] : live_blocks) {
+            auto age = std::chrono::duration_cast<std::chrono::microseconds>(now - record.time).count();
+            out << "  " << ptr << " size=" << record.size << " align=" << record.alignment 
+                << " age=" << age << "us tag=" << (record.tag ? record.tag : "-") << "\n";
+        }
+    }
+#else
+    void enable_tracing(bool = true, std::ostream* = nullptr) {}
+    
+    void set_allocation_tag(const char*) {}
+    
+    size_t live_allocation_count() const {
+        return 0;
+    }
+    
+    void write_leak_report(std::ostream&) const {}
+#endif
 };
 
+#if defined(__GNUC__) || defined(__clang__)
+#define QUEUE_COLD __attribute__((cold, noinline))
+#else
+#define QUEUE_COLD
+#endif
+
+// Бросок вынесен из push/pop/front, чтобы горячий путь оставался коротким
+// и встраивался.
+[[noreturn]] QUEUE_COLD inline void throw_queue_empty() {
+    throw std::runtime_error("Queue is empty");
+}
+
 template<typename T>
 struct QueueNode {
     T data;
@@ -73,19 +231,31 @@ struct QueueNode {
         : data(std::forward<Args>(args)...), next(nullptr) {}
 };
 
-template<typename T>
+template<typename T, typename Alloc>
+class Queue;
+
+template<typename T, bool IsConst = false>
 class QueueIterator {
 private:
-    QueueNode<T>* current;
+    using node_pointer = std::conditional_t<IsConst, const QueueNode<T>*, QueueNode<T>*>;
+    
+    template<typename, typename>
+    friend class Queue;
+    
+    node_pointer current;
 
 public:
     using iterator_category = std::forward_iterator_tag;
     using value_type = T;
     using difference_type = std::ptrdiff_t;
-    using pointer = T*;
-    using reference = T&;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
 
-    explicit QueueIterator(QueueNode<T>* node = nullptr) : current(node) {}
+    explicit QueueIterator(node_pointer node = nullptr) : current(node) {}
+
+    operator QueueIterator<T, true>() const requires (!IsConst) {
+        return QueueIterator<T, true>(current);
+    }
 
     reference operator*() const { 
         return current->data; 
@@ -117,52 +287,327 @@ public:
     }
 };
 
+constexpr size_t queue_cache_line_size = 64;
+constexpr size_t queue_default_prefetch_distance = 8;
+constexpr size_t queue_default_node_cache_limit = 32;
+constexpr size_t queue_chunk_gather_size = 256;
+
+// Вызывает обработчик отрезка; обработчик может вернуть false, чтобы
+// остановить обход
+template<typename F, typename Span>
+inline bool queue_visit_chunk(F& f, Span chunk) {
+    if constexpr (std::is_same_v<std::invoke_result_t<F&, Span>, bool>) {
+        return f(chunk);
+    } else {
+        f(chunk);
+        return true;
+    }
+}
+
+template<typename T>
+inline void prefetch_node(const QueueNode<T>* node) {
+#if defined(__GNUC__) || defined(__clang__)
+    if (node) {
+        const char* bytes = reinterpret_cast<const char*>(node);
+        for (size_t offset = 0; offset < sizeof(QueueNode<T>); offset += queue_cache_line_size) {
+            __builtin_prefetch(bytes + offset, 0, 3);
+        }
+    }
+#else
+    (void)node;
+#endif
+}
+
+// Итератор с упреждающей выборкой: второй указатель идёт на distance узлов
+// впереди текущего и заранее подтягивает узлы в кэш.
 template<typename T>
+class QueuePrefetchIterator {
+private:
+    QueueNode<T>* current;
+    QueueNode<T>* ahead;
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    explicit QueuePrefetchIterator(QueueNode<T>* node = nullptr, 
+                                   size_t distance = queue_default_prefetch_distance)
+        : current(node), ahead(node) {
+        for (size_t i = 0; i < distance && ahead; ++i) {
+            ahead = ahead->next;
+            prefetch_node(ahead);
+        }
+    }
+
+    reference operator*() const { 
+        return current->data; 
+    }
+    
+    pointer operator->() const { 
+        return &current->data; 
+    }
+
+    QueuePrefetchIterator& operator++() {
+        if (current) {
+            current = current->next;
+        }
+        if (ahead) {
+            ahead = ahead->next;
+            prefetch_node(ahead);
+        }
+        return *this;
+    }
+
+    QueuePrefetchIterator operator++(int) {
+        QueuePrefetchIterator temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    bool operator==(const QueuePrefetchIterator& other) const {
+        return current == other.current;
+    }
+
+    bool operator!=(const QueuePrefetchIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+template<typename T, typename Index = std::deque<QueueNode<T>*>>
+class QueueIndexIterator {
+private:
+    using node_iterator = typename Index::const_iterator;
+    
+    node_iterator current;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    QueueIndexIterator() = default;
+
+    explicit QueueIndexIterator(node_iterator it) : current(it) {}
+
+    reference operator*() const { 
+        return (*current)->data; 
+    }
+    
+    pointer operator->() const { 
+        return &(*current)->data; 
+    }
+
+    reference operator[](difference_type n) const {
+        return current[n]->data;
+    }
+
+    QueueIndexIterator& operator++() {
+        ++current;
+        return *this;
+    }
+
+    QueueIndexIterator operator++(int) {
+        QueueIndexIterator temp = *this;
+        ++current;
+        return temp;
+    }
+
+    QueueIndexIterator& operator--() {
+        --current;
+        return *this;
+    }
+
+    QueueIndexIterator operator--(int) {
+        QueueIndexIterator temp = *this;
+        --current;
+        return temp;
+    }
+
+    QueueIndexIterator& operator+=(difference_type n) {
+        current += n;
+        return *this;
+    }
+
+    QueueIndexIterator& operator-=(difference_type n) {
+        current -= n;
+        return *this;
+    }
+
+    friend QueueIndexIterator operator+(QueueIndexIterator it, difference_type n) {
+        return it += n;
+    }
+
+    friend QueueIndexIterator operator+(difference_type n, QueueIndexIterator it) {
+        return it += n;
+    }
+
+    friend QueueIndexIterator operator-(QueueIndexIterator it, difference_type n) {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const QueueIndexIterator& a, const QueueIndexIterator& b) {
+        return a.current - b.current;
+    }
+
+    bool operator==(const QueueIndexIterator& other) const {
+        return current == other.current;
+    }
+
+    auto operator<=>(const QueueIndexIterator& other) const {
+        return current <=> other.current;
+    }
+};
+
+template<typename T, typename Index = std::deque<QueueNode<T>*>>
+class QueueIndexView {
+private:
+    const Index* nodes;
+
+public:
+    using iterator = QueueIndexIterator<T, Index>;
+
+    explicit QueueIndexView(const Index& index) : nodes(&index) {}
+
+    iterator begin() const {
+        return iterator(nodes->begin());
+    }
+
+    iterator end() const {
+        return iterator(nodes->end());
+    }
+
+    size_t size() const {
+        return nodes->size();
+    }
+
+    T& operator[](size_t i) const {
+        return (*nodes)[i]->data;
+    }
+};
+
+template<typename T, typename Alloc = std::pmr::polymorphic_allocator<T>>
 class Queue {
+public:
+    using allocator_type = Alloc;
+    
 private:
-    using allocator_type = std::pmr::polymorphic_allocator<QueueNode<T>>;
+    using node_allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<QueueNode<T>>;
+    using node_traits = std::allocator_traits<node_allocator_type>;
+    
+    // Списки узлов для меток сегментов и индекса живут на том же
+    // распределителе, что и узлы, и создаются только при включении
+    using node_list_allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<QueueNode<T>*>;
+    using node_list = std::deque<QueueNode<T>*, node_list_allocator_type>;
+    using node_list_holder_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node_list>;
+    using node_list_traits = std::allocator_traits<node_list_holder_type>;
     
     QueueNode<T>* head;
     QueueNode<T>* tail;
     size_t size_;
-    allocator_type allocator;
+    node_allocator_type allocator;
     
-public:
-    using iterator = QueueIterator<T>;
+    size_t segment_length;
+    size_t tail_segment_size;
+    node_list* segment_marks;
     
-    explicit Queue(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
-        : head(nullptr), tail(nullptr), size_(0), allocator(mr) {}
+    bool indexed;
+    node_list* node_index;
     
-    Queue(const Queue& other) : head(nullptr), tail(nullptr), size_(0), 
-                               allocator(other.allocator) {
-        QueueNode<T>* current = other.head;
-        while (current) {
-            push(current->data);
-            current = current->next;
-        }
-    }
+    struct CachedNode {
+        CachedNode* next;
+    };
     
-    Queue(Queue&& other) noexcept 
-        : head(other.head), tail(other.tail), size_(other.size_), 
-          allocator(std::move(other.allocator)) {
-        other.head = nullptr;
-        other.tail = nullptr;
-        other.size_ = 0;
-    }
+    CachedNode* node_cache;
+    size_t cached_nodes;
+    size_t node_cache_max;
     
-    ~Queue() {
-        clear();
+    QueueNode<T>* unlink_front() {
+        QueueNode<T>* temp = head;
+        head = head->next;
+        
+        if (!head) {
+            tail = nullptr;
+            tail_segment_size = 0;
+        } else if (segment_length) {
+            if (segment_marks->empty()) {
+                --tail_segment_size;
+            } else if (segment_marks->front() == head) {
+                segment_marks->pop_front();
+            }
+        }
+        if (indexed) {
+            node_index->pop_front();
+        }
+        --size_;
+        return temp;
     }
     
-    void push(T& value) {
-        auto* new_node = allocator.allocate(1);
+    node_list* make_node_list() {
+        node_list_holder_type list_allocator(allocator);
+        node_list* list = node_list_traits::allocate(list_allocator, 1);
         try {
-            allocator.construct(new_node, value);  
+            ::new (static_cast<void*>(list)) node_list(node_list_allocator_type(allocator));
         } catch (...) {
-            allocator.deallocate(new_node, 1);
+            node_list_traits::deallocate(list_allocator, list, 1);
             throw;
         }
-        
+        return list;
+    }
+    
+    void drop_node_list(node_list*& list) noexcept {
+        if (!list) {
+            return;
+        }
+        node_list_holder_type list_allocator(allocator);
+        list->~node_list();
+        node_list_traits::deallocate(list_allocator, list, 1);
+        list = nullptr;
+    }
+    
+    QueueNode<T>* allocate_node() {
+        if (node_cache) {
+            CachedNode* cached = node_cache;
+            node_cache = cached->next;
+            --cached_nodes;
+            return reinterpret_cast<QueueNode<T>*>(cached);
+        }
+        return node_traits::allocate(allocator, 1);
+    }
+    
+    // Освобождённые узлы сначала оседают в кэше, минуя виртуальный вызов
+    // memory_resource; в ресурс уходят только сверх node_cache_max.
+    void release_node(QueueNode<T>* node) {
+        if (cached_nodes < node_cache_max) {
+            node_cache = ::new (static_cast<void*>(node)) CachedNode{node_cache};
+            ++cached_nodes;
+        } else {
+            node_traits::deallocate(allocator, node, 1);
+        }
+    }
+    
+    void destroy_node(QueueNode<T>* node) {
+        node_traits::destroy(allocator, node);
+        release_node(node);
+    }
+    
+    // Узел освобождается и в том случае, если перемещение элемента бросило.
+    T take_front() {
+        QueueNode<T>* node = unlink_front();
+        struct NodeGuard {
+            Queue* owner;
+            QueueNode<T>* node;
+            ~NodeGuard() { owner->destroy_node(node); }
+        } guard{this, node};
+        return std::move(node->data);
+    }
+    
+    void link_back(QueueNode<T>* new_node) {
         new_node->next = nullptr;
         
         if (tail) {
@@ -172,55 +617,279 @@ public:
         }
         tail = new_node;
         ++size_;
+        
+        if (segment_length && ++tail_segment_size > segment_length) {
+            segment_marks->push_back(new_node);
+            tail_segment_size = 1;
+        }
+        if (indexed) {
+            node_index->push_back(new_node);
+        }
+    }
+    
+    // Забирает цепочку, разметку и кэш узлов; распределители должны совпадать.
+    void steal(Queue& other) noexcept {
+        head = std::exchange(other.head, nullptr);
+        tail = std::exchange(other.tail, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        segment_length = std::exchange(other.segment_length, 0);
+        tail_segment_size = std::exchange(other.tail_segment_size, 0);
+        segment_marks = std::exchange(other.segment_marks, nullptr);
+        indexed = std::exchange(other.indexed, false);
+        node_index = std::exchange(other.node_index, nullptr);
+        node_cache = std::exchange(other.node_cache, nullptr);
+        cached_nodes = std::exchange(other.cached_nodes, 0);
+        node_cache_max = other.node_cache_max;
+    }
+    
+    // Метки сегментов и индекс заново по текущей цепочке
+    void rebuild_markup() {
+        if (segment_length) {
+            enable_segments(segment_length);
+        }
+        if (indexed) {
+            enable_index(true);
+        }
+    }
+    
+    // Выживший узел при проходе erase_if: та же разметка, что в link_back
+    void mark_survivor(QueueNode<T>* node) {
+        if (segment_length && ++tail_segment_size > segment_length) {
+            segment_marks->push_back(node);
+            tail_segment_size = 1;
+        }
+        if (indexed) {
+            node_index->push_back(node);
+        }
+    }
+    
+    // Снимает разметку с узла, удаляемого из середины цепочки, без полного
+    // пересчёта: метка сегмента переезжает на следующий узел, запись индекса
+    // стирается. Если узел не метка и меток несколько, хвостовой счётчик не
+    // уменьшается - сегменты остаются не длиннее segment_length.
+    void unmark_node(QueueNode<T>* node) {
+        if (segment_length) {
+            auto mark = std::find(segment_marks->begin(), segment_marks->end(), node);
+            if (mark == segment_marks->end()) {
+                if (segment_marks->empty()) {
+                    --tail_segment_size;
+                }
+            } else {
+                bool last_mark = mark + 1 == segment_marks->end();
+                QueueNode<T>* next = node->next;
+                if (next && (last_mark || *(mark + 1) != next)) {
+                    *mark = next;
+                    if (last_mark) {
+                        --tail_segment_size;
+                    }
+                } else {
+                    segment_marks->erase(mark);
+                    if (last_mark) {
+                        // Хвостовым стал предыдущий сегмент, его длина не больше segment_length
+                        tail_segment_size = segment_length;
+                    }
+                }
+            }
+        }
+        if (indexed) {
+            node_index->erase(std::find(node_index->begin(), node_index->end(), node));
+        }
+    }
+    
+    // Удалённые узлы освобождаются одной пачкой после перелинковки
+    void release_chain(QueueNode<T>* removed, size_t erased) {
+        size_ -= erased;
+        while (removed) {
+            QueueNode<T>* next = removed->next;
+            destroy_node(removed);
+            removed = next;
+        }
+    }
+    
+    void copy_elements(const Queue& other) {
+        enable_segments(other.segment_length);
+        enable_index(other.indexed);
+        node_cache_max = other.node_cache_max;
+        for (QueueNode<T>* current = other.head; current; current = current->next) {
+            push(current->data);
+        }
+    }
+    
+public:
+    using iterator = QueueIterator<T>;
+    using const_iterator = QueueIterator<T, true>;
+    using prefetch_iterator = QueuePrefetchIterator<T>;
+    using index_view = QueueIndexView<T, node_list>;
+    
+    Queue() : Queue(allocator_type()) {}
+    
+    explicit Queue(const allocator_type& alloc)
+        : head(nullptr), tail(nullptr), size_(0), allocator(alloc), 
+          segment_length(0), tail_segment_size(0), segment_marks(nullptr), indexed(false), node_index(nullptr), 
+          node_cache(nullptr), cached_nodes(0), node_cache_max(queue_default_node_cache_limit) {}
+    
+    explicit Queue(std::pmr::memory_resource* mr) 
+        requires std::is_constructible_v<allocator_type, std::pmr::memory_resource*>
+        : Queue(allocator_type(mr)) {}
+    
+    // Копия остаётся на ресурсе оригинала (в том числе для pmr, где
+    // select_on_container_copy_construction вернул бы ресурс по умолчанию).
+    Queue(const Queue& other) : Queue(allocator_type(other.allocator)) {
+        copy_elements(other);
+    }
+    
+    Queue(Queue&& other) noexcept : Queue(allocator_type(other.allocator)) {
+        steal(other);
+    }
+    
+    Queue& operator=(const Queue& other) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        if constexpr (node_traits::propagate_on_container_copy_assignment::value) {
+            if (allocator != other.allocator) {
+                shrink();
+                drop_node_list(segment_marks);
+                drop_node_list(node_index);
+                segment_length = 0;
+                indexed = false;
+            }
+            allocator = other.allocator;
+        }
+        copy_elements(other);
+        return *this;
+    }
+    
+    Queue& operator=(Queue&& other) noexcept(node_traits::propagate_on_container_move_assignment::value || 
+                                             node_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        shrink();
+        drop_node_list(segment_marks);
+        drop_node_list(node_index);
+        segment_length = 0;
+        indexed = false;
+        if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+            allocator = std::move(other.allocator);
+            steal(other);
+        } else {
+            if (allocator == other.allocator) {
+                steal(other);
+            } else {
+                // Чужой распределитель: узлы нельзя забрать, элементы переносятся по одному
+                enable_segments(other.segment_length);
+                enable_index(other.indexed);
+                node_cache_max = other.node_cache_max;
+                while (!other.empty()) {
+                    push(other.pop_value());
+                }
+            }
+        }
+        return *this;
+    }
+    
+    void swap(Queue& other) noexcept(node_traits::propagate_on_container_swap::value || 
+                                     node_traits::is_always_equal::value) {
+        if constexpr (node_traits::propagate_on_container_swap::value) {
+            std::swap(allocator, other.allocator);
+        } else if (allocator != other.allocator) {
+            // Каждая очередь остаётся на своём ресурсе, элементы переносятся
+            Queue temp(allocator_type(other.allocator));
+            temp = std::move(*this);
+            *this = std::move(other);
+            other = std::move(temp);
+            return;
+        }
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(size_, other.size_);
+        std::swap(segment_length, other.segment_length);
+        std::swap(tail_segment_size, other.tail_segment_size);
+        std::swap(segment_marks, other.segment_marks);
+        std::swap(indexed, other.indexed);
+        std::swap(node_index, other.node_index);
+        std::swap(node_cache, other.node_cache);
+        std::swap(cached_nodes, other.cached_nodes);
+        std::swap(node_cache_max, other.node_cache_max);
+    }
+    
+    friend void swap(Queue& a, Queue& b) noexcept(noexcept(a.swap(b))) {
+        a.swap(b);
+    }
+    
+    ~Queue() {
+        clear();
+        shrink();
+        drop_node_list(segment_marks);
+        drop_node_list(node_index);
+    }
+    
+    void push(T& value) {
+        auto* new_node = allocate_node();
+        try {
+            node_traits::construct(allocator, new_node, value);  
+        } catch (...) {
+            release_node(new_node);
+            throw;
+        }
+        
+        link_back(new_node);
     }
  
     void push(T&& value) {
-        auto* new_node = allocator.allocate(1);
+        auto* new_node = allocate_node();
         try {
-            allocator.construct(new_node, std::move(value));  
+            node_traits::construct(allocator, new_node, std::move(value));  
         } catch (...) {
-            allocator.deallocate(new_node, 1);
+            release_node(new_node);
             throw;
         }
         
-        new_node->next = nullptr;
-        
-        if (tail) {
-            tail->next = new_node;
-        } else {
-            head = new_node;
-        }
-        tail = new_node;
-        ++size_;
+        link_back(new_node);
     }
    
     void pop() {
-        if (empty()) {
-            throw std::runtime_error("Queue is empty");
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
         }
-        
-        QueueNode<T>* temp = head;
-        head = head->next;
-        
+        destroy_node(unlink_front());
+    }
+    
+    T* try_front() noexcept {
+        return head ? &head->data : nullptr;
+    }
+    
+    T* try_back() noexcept {
+        return tail ? &tail->data : nullptr;
+    }
+    
+    std::optional<T> try_pop() {
         if (!head) {
-            tail = nullptr;
+            return std::nullopt;
         }
-        
-        std::allocator_traits<allocator_type>::destroy(allocator, temp);
-        allocator.deallocate(temp, 1);
-        --size_;
+        return std::optional<T>(take_front());
+    }
+    
+    T pop_value() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return take_front();
     }
     
     T& front() {
-        if (empty()) {
-            throw std::runtime_error("Queue is empty");
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
         }
         return head->data;
     }
     
     T& back() {
-        if (empty()) {
-            throw std::runtime_error("Queue is empty");
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
         }
         return tail->data;
     }
@@ -239,6 +908,116 @@ public:
         }
     }
     
+    // Возвращает в memory_resource все закэшированные узлы.
+    void shrink() {
+        while (node_cache) {
+            CachedNode* cached = node_cache;
+            node_cache = cached->next;
+            node_traits::deallocate(allocator, reinterpret_cast<QueueNode<T>*>(cached), 1);
+        }
+        cached_nodes = 0;
+    }
+    
+    void set_node_cache_limit(size_t limit) {
+        node_cache_max = limit;
+        while (cached_nodes > node_cache_max) {
+            CachedNode* cached = node_cache;
+            node_cache = cached->next;
+            --cached_nodes;
+            node_traits::deallocate(allocator, reinterpret_cast<QueueNode<T>*>(cached), 1);
+        }
+    }
+    
+    // Удаляет элементы, для которых pred вернул true, за один проход:
+    // выжившие узлы остаются на месте, меняются только ссылки next.
+    // Возвращает число удалённых элементов.
+    template<typename Pred>
+    size_t erase_if(Pred pred) {
+        QueueNode<T>* removed = nullptr;
+        size_t erased = 0;
+        QueueNode<T>** link = &head;
+        QueueNode<T>* last = nullptr;
+        // Разметка собирается по выжившим в том же проходе
+        if (segment_marks) {
+            segment_marks->clear();
+        }
+        tail_segment_size = 0;
+        if (node_index) {
+            node_index->clear();
+        }
+        try {
+            while (QueueNode<T>* current = *link) {
+                if (pred(current->data)) {
+                    *link = current->next;
+                    current->next = removed;
+                    removed = current;
+                    ++erased;
+                } else {
+                    mark_survivor(current);
+                    last = current;
+                    link = &current->next;
+                }
+            }
+        } catch (...) {
+            // Хвост ещё не тронут: удалены только узлы до брошенного
+            rebuild_markup();
+            release_chain(removed, erased);
+            throw;
+        }
+        tail = last;
+        release_chain(removed, erased);
+        return erased;
+    }
+    
+    // Удаляет элемент после pos; возвращает итератор на следующий за
+    // удалённым. Как у forward_list, удаление за O(1) без поиска предыдущего,
+    // но с включёнными сегментами добавляется поиск метки (O(числа меток)),
+    // а с индексом - сдвиг индекса (O(n)). Для массового удаления - erase_if,
+    // он собирает разметку один раз за проход.
+    iterator erase_after(const_iterator pos) {
+        QueueNode<T>* prev = const_cast<QueueNode<T>*>(pos.current);
+        if (!prev || !prev->next) {
+            throw std::out_of_range("Queue::erase_after has no following element");
+        }
+        QueueNode<T>* node = prev->next;
+        unmark_node(node);
+        prev->next = node->next;
+        if (tail == node) {
+            tail = prev;
+        }
+        node->next = nullptr;
+        release_chain(node, 1);
+        return iterator(prev->next);
+    }
+    
+    // Удаление произвольного элемента требует поиска предыдущего узла -
+    // O(позиции); голова снимается как pop().
+    iterator erase(const_iterator pos) {
+        if (!pos.current) {
+            throw std::out_of_range("Queue::erase at end()");
+        }
+        if (pos.current == head) {
+            destroy_node(unlink_front());
+            return begin();
+        }
+        QueueNode<T>* prev = head;
+        while (prev && prev->next != pos.current) {
+            prev = prev->next;
+        }
+        if (!prev) {
+            throw std::out_of_range("Queue::erase iterator does not belong to the queue");
+        }
+        return erase_after(const_iterator(prev));
+    }
+    
+    size_t node_cache_limit() const {
+        return node_cache_max;
+    }
+    
+    size_t cached_node_count() const {
+        return cached_nodes;
+    }
+    
     iterator begin() { 
         return iterator(head); 
     }
@@ -246,6 +1025,147 @@ public:
     iterator end() { 
         return iterator(nullptr); 
     }
+
+    const_iterator begin() const { 
+        return const_iterator(head); 
+    }
+
+    const_iterator end() const { 
+        return const_iterator(nullptr); 
+    }
+
+    const_iterator cbegin() const { 
+        return begin(); 
+    }
+
+    const_iterator cend() const { 
+        return end(); 
+    }
+
+    // Разбиение цепочки на сегменты не длиннее length узлов для параллельного
+    // обхода; 0 отключает поддержку меток и освобождает их список.
+    void enable_segments(size_t length) {
+        tail_segment_size = 0;
+        if (!length) {
+            segment_length = 0;
+            drop_node_list(segment_marks);
+            return;
+        }
+        if (!segment_marks) {
+            segment_marks = make_node_list();
+        }
+        segment_length = length;
+        segment_marks->clear();
+        for (QueueNode<T>* current = head; current; current = current->next) {
+            if (++tail_segment_size > segment_length) {
+                segment_marks->push_back(current);
+                tail_segment_size = 1;
+            }
+        }
+    }
+    
+    size_t segment_size() const {
+        return segment_length;
+    }
+    
+    std::vector<std::pair<iterator, iterator>> segments() {
+        std::vector<std::pair<iterator, iterator>> result;
+        if (empty()) {
+            return result;
+        }
+        QueueNode<T>* first = head;
+        if (segment_marks) {
+            result.reserve(segment_marks->size() + 1);
+            for (QueueNode<T>* mark : *segment_marks) {
+                result.emplace_back(iterator(first), iterator(mark));
+                first = mark;
+            }
+        }
+        result.emplace_back(iterator(first), end());
+        return result;
+    }
+    
+    // Индекс узлов даёт доступ по номеру за O(1) ценой одного указателя
+    // на элемент; без индекса operator[] проходит цепочку от головы.
+    // Выключение освобождает индекс.
+    void enable_index(bool enable = true) {
+        if (!enable) {
+            indexed = false;
+            drop_node_list(node_index);
+            return;
+        }
+        if (!node_index) {
+            node_index = make_node_list();
+        }
+        indexed = true;
+        node_index->clear();
+        for (QueueNode<T>* current = head; current; current = current->next) {
+            node_index->push_back(current);
+        }
+    }
+    
+    bool is_indexed() const {
+        return indexed;
+    }
+    
+    T& operator[](size_t i) {
+        if (indexed) {
+            return (*node_index)[i]->data;
+        }
+        QueueNode<T>* current = head;
+        while (i--) {
+            current = current->next;
+        }
+        return current->data;
+    }
+    
+    T& at(size_t i) {
+        if (i >= size_) {
+            throw std::out_of_range("Queue index out of range");
+        }
+        return (*this)[i];
+    }
+    
+    index_view indexed_view() {
+        if (!indexed) {
+            throw std::runtime_error("Queue index is disabled");
+        }
+        return index_view(*node_index);
+    }
+    
+    prefetch_iterator prefetch_begin(size_t distance = queue_default_prefetch_distance) {
+        return prefetch_iterator(head, distance);
+    }
+
+    prefetch_iterator prefetch_end() {
+        return prefetch_iterator(nullptr, 0);
+    }
+
+    template<typename F>
+    void for_each_prefetched(F&& f, size_t distance = queue_default_prefetch_distance) {
+        for (auto it = prefetch_begin(distance); it != prefetch_end(); ++it) {
+            f(*it);
+        }
+    }
+
+    // Узлы не лежат подряд, поэтому арифметические элементы собираются в
+    // буфер на стеке по queue_chunk_gather_size штук и отдаются как
+    // std::span<const T> - под векторные ядра из simd_kernels.hpp
+    template<typename F>
+        requires std::is_arithmetic_v<T>
+    void for_each_chunk(F&& f) const {
+        T buffer[queue_chunk_gather_size];
+        const QueueNode<T>* current = head;
+        while (current) {
+            size_t count = 0;
+            for (; current && count < queue_chunk_gather_size; current = current->next) {
+                buffer[count++] = current->data;
+            }
+            if (!queue_visit_chunk(f, std::span<const T>(buffer, count))) {
+                return;
+            }
+        }
+    }
     
-    allocator_type get_allocator() const { return allocator; }
+    allocator_type get_allocator() const { return allocator_type(allocator); }
 };
\ No newline at end of file
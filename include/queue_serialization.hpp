@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "queue.hpp"
+
+// Формат: заголовок QueueBlobHeader, затем либо count * element_size байт
+// подряд (для тривиально копируемых T), либо для каждого элемента длина
+// uint32_t и байты, записанные QueueSerializer<T>.
+
+template<typename T>
+struct QueueSerializer;
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+struct QueueSerializer<T> {
+    static constexpr bool contiguous = true;
+
+    static size_t size(const T&) {
+        return sizeof(T);
+    }
+
+    static void write(const T& value, std::byte* out) {
+        std::memcpy(out, &value, sizeof(T));
+    }
+
+    static T read(const std::byte* in, size_t) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        return value;
+    }
+};
+
+template<>
+struct QueueSerializer<std::string> {
+    static size_t size(const std::string& value) {
+        return value.size();
+    }
+
+    static void write(const std::string& value, std::byte* out) {
+        std::memcpy(out, value.data(), value.size());
+    }
+
+    static std::string read(const std::byte* in, size_t size) {
+        return std::string(reinterpret_cast<const char*>(in), size);
+    }
+};
+
+template<typename T>
+constexpr bool queue_serializer_is_contiguous() {
+    if constexpr (requires { QueueSerializer<T>::contiguous; }) {
+        return QueueSerializer<T>::contiguous;
+    } else {
+        return false;
+    }
+}
+
+struct QueueBlobHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t flags;
+    uint64_t element_size;
+    uint64_t count;
+    uint64_t payload_bytes;
+};
+
+constexpr uint32_t queue_blob_version = 1;
+constexpr uint32_t queue_blob_byte_order = 0x01020304;
+constexpr uint32_t queue_blob_contiguous = 1;
+
+template<typename T, typename Alloc>
+size_t serialized_size(const Queue<T, Alloc>& queue) {
+    if constexpr (queue_serializer_is_contiguous<T>()) {
+        return sizeof(QueueBlobHeader) + queue.size() * sizeof(T);
+    } else {
+        size_t total = sizeof(QueueBlobHeader);
+        for (const T& value : queue) {
+            size_t length = QueueSerializer<T>::size(value);
+            // Длина записи хранится в uint32_t
+            if (length > std::numeric_limits<uint32_t>::max()) {
+                throw std::length_error("Queue element is too large to serialize");
+            }
+            total += sizeof(uint32_t) + length;
+        }
+        return total;
+    }
+}
+
+template<typename T, typename Alloc>
+void serialize_queue(const Queue<T, Alloc>& queue, std::vector<std::byte>& out) {
+    size_t start = out.size();
+    out.resize(start + serialized_size(queue));
+    std::byte* cursor = out.data() + start;
+
+    QueueBlobHeader header{{'Q', 'B', 'L', 'B'}, queue_blob_version, queue_blob_byte_order, 
+                           queue_serializer_is_contiguous<T>() ? queue_blob_contiguous : 0, 
+                           sizeof(T), queue.size(), out.size() - start - sizeof(QueueBlobHeader)};
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+
+    for (const T& value : queue) {
+        if constexpr (queue_serializer_is_contiguous<T>()) {
+            QueueSerializer<T>::write(value, cursor);
+            cursor += sizeof(T);
+        } else {
+            uint32_t length = static_cast<uint32_t>(QueueSerializer<T>::size(value));
+            std::memcpy(cursor, &length, sizeof(length));
+            cursor += sizeof(length);
+            QueueSerializer<T>::write(value, cursor);
+            cursor += length;
+        }
+    }
+}
+
+template<typename T, typename Alloc>
+std::vector<std::byte> serialize_queue(const Queue<T, Alloc>& queue) {
+    std::vector<std::byte> out;
+    serialize_queue(queue, out);
+    return out;
+}
+
+inline QueueBlobHeader read_queue_blob_header(std::span<const std::byte> blob) {
+    QueueBlobHeader header;
+    if (blob.size() < sizeof(header)) {
+        throw std::runtime_error("Queue blob is truncated");
+    }
+    std::memcpy(&header, blob.data(), sizeof(header));
+    if (std::memcmp(header.magic, "QBLB", 4) != 0) {
+        throw std::runtime_error("Not a queue blob");
+    }
+    if (header.version != queue_blob_version || header.byte_order != queue_blob_byte_order) {
+        throw std::runtime_error("Unsupported queue blob version");
+    }
+    if (blob.size() - sizeof(header) < header.payload_bytes) {
+        throw std::runtime_error("Queue blob is truncated");
+    }
+    // Каждый элемент занимает не меньше element_size (или длины записи)
+    // байт, так что count ограничен объёмом данных; произведение count на
+    // размер здесь не считается, чтобы испорченный заголовок не переполнил его
+    uint64_t min_record = (header.flags & queue_blob_contiguous) ? header.element_size : sizeof(uint32_t);
+    if (min_record == 0 || header.count > header.payload_bytes / min_record) {
+        throw std::runtime_error("Queue blob is corrupted");
+    }
+    return header;
+}
+
+// Объём памяти под узлы, который займёт десериализация: им удобно задать
+// начальный буфер monotonic_buffer_resource, чтобы все узлы получить одним
+// выделением у вышестоящего ресурса.
+template<typename T>
+size_t deserialized_node_bytes(std::span<const std::byte> blob) {
+    return read_queue_blob_header(blob).count * sizeof(QueueNode<T>);
+}
+
+template<typename T>
+Queue<T> deserialize_queue(std::span<const std::byte> blob, 
+                           std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+    QueueBlobHeader header = read_queue_blob_header(blob);
+    bool contiguous = queue_serializer_is_contiguous<T>();
+    if ((header.flags & queue_blob_contiguous) != (contiguous ? queue_blob_contiguous : 0) || 
+        header.element_size != sizeof(T)) {
+        throw std::runtime_error("Queue blob holds another element type");
+    }
+
+    Queue<T> queue(mr);
+    const std::byte* cursor = blob.data() + sizeof(header);
+    const std::byte* limit = cursor + header.payload_bytes;
+    if (contiguous && (header.count != header.payload_bytes / sizeof(T) || header.payload_bytes % sizeof(T))) {
+        throw std::runtime_error("Queue blob is corrupted");
+    }
+    for (uint64_t i = 0; i < header.count; ++i) {
+        size_t length = sizeof(T);
+        if (!contiguous) {
+            uint32_t stored;
+            if (limit - cursor < static_cast<std::ptrdiff_t>(sizeof(stored))) {
+                throw std::runtime_error("Queue blob is corrupted");
+            }
+            std::memcpy(&stored, cursor, sizeof(stored));
+            cursor += sizeof(stored);
+            length = stored;
+            if (limit - cursor < static_cast<std::ptrdiff_t>(length)) {
+                throw std::runtime_error("Queue blob is corrupted");
+            }
+        }
+        queue.push(QueueSerializer<T>::read(cursor, length));
+        cursor += length;
+    }
+    return queue;
+}
+
+template<typename T, typename Alloc>
+void write_queue_file(const Queue<T, Alloc>& queue, const std::filesystem::path& path) {
+    std::vector<std::byte> blob = serialize_queue(queue);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    if (!out) {
+        throw std::runtime_error("Failed to write queue file");
+    }
+}
+
+template<typename T>
+Queue<T> read_queue_file(const std::filesystem::path& path, 
+                         std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open queue file");
+    }
+    std::vector<std::byte> blob(static_cast<size_t>(std::filesystem::file_size(path)));
+    in.read(reinterpret_cast<char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    return deserialize_queue<T>(blob, mr);
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory_resource>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Событие трассы выделений. id связывает освобождение с выделением,
+// time_ns - время от создания записывающего ресурса.
+struct AllocationEvent {
+    enum class Kind : uint8_t {
+        Allocate = 0,
+        Deallocate = 1
+    };
+
+    Kind kind;
+    size_t alignment;
+    uint64_t id;
+    uint64_t size;
+    uint64_t time_ns;
+};
+
+// Формат трассы: заголовок "QATR" и байт версии, затем события подряд.
+// Событие - байт (вид в старшем бите, log2 выравнивания в младших) и три
+// LEB128-числа: приращение времени в нс, id и размер. Типичное событие
+// занимает 4-6 байт.
+constexpr char allocation_trace_magic[4] = {'Q', 'A', 'T', 'R'};
+constexpr uint8_t allocation_trace_version = 1;
+
+// Прозрачная обёртка над upstream, пишущая каждое allocate/deallocate в
+// бинарную трассу; трасса потом проигрывается утилитой replay.
+class RecordingMemoryResource : public std::pmr::memory_resource {
+private:
+    std::ostream& out;
+    std::pmr::memory_resource* upstream;
+    std::unordered_map<void*, uint64_t> live_ids;
+    uint64_t next_id = 0;
+    uint64_t event_count = 0;
+    std::chrono::steady_clock::time_point start;
+    uint64_t last_time_ns = 0;
+
+    void write_varint(uint64_t value) {
+        char bytes[10];
+        size_t n = 0;
+        do {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            bytes[n++] = static_cast<char>(value ? byte | 0x80 : byte);
+        } while (value);
+        out.write(bytes, static_cast<std::streamsize>(n));
+    }
+
+    void write_event(AllocationEvent::Kind kind, size_t alignment, uint64_t id, uint64_t size) {
+        uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        uint8_t alignment_log2 = 0;
+        while ((size_t(1) << alignment_log2) < alignment) {
+            ++alignment_log2;
+        }
+        out.put(static_cast<char>((static_cast<uint8_t>(kind) << 7) | alignment_log2));
+        write_varint(now - last_time_ns);
+        write_varint(id);
+        write_varint(size);
+        last_time_ns = now;
+        ++event_count;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* p = upstream->allocate(bytes, alignment);
+        uint64_t id = next_id++;
+        live_ids[p] = id;
+        write_event(AllocationEvent::Kind::Allocate, alignment, id, bytes);
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        auto it = live_ids.find(p);
+        if (it == live_ids.end()) {
+            throw std::invalid_argument("Attempt to deallocate unknown block");
+        }
+        write_event(AllocationEvent::Kind::Deallocate, alignment, it->second, bytes);
+        live_ids.erase(it);
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit RecordingMemoryResource(std::ostream& trace,
+                                     std::pmr::memory_resource* upstream_mr = std::pmr::new_delete_resource())
+        : out(trace), upstream(upstream_mr), start(std::chrono::steady_clock::now()) {
+        out.write(allocation_trace_magic, sizeof(allocation_trace_magic));
+        out.put(static_cast<char>(allocation_trace_version));
+    }
+
+    RecordingMemoryResource(const RecordingMemoryResource&) = delete;
+    RecordingMemoryResource& operator=(const RecordingMemoryResource&) = delete;
+
+    ~RecordingMemoryResource() override {
+        out.flush();
+    }
+
+    uint64_t recorded_events() const {
+        return event_count;
+    }
+
+    size_t live_allocations() const {
+        return live_ids.size();
+    }
+
+    std::pmr::memory_resource* upstream_resource() const {
+        return upstream;
+    }
+};
+
+inline std::vector<AllocationEvent> read_allocation_trace(std::istream& in) {
+    char magic[sizeof(allocation_trace_magic)];
+    if (!in.read(magic, sizeof(magic)) ||
+        !std::equal(magic, magic + sizeof(magic), allocation_trace_magic) ||
+        in.get() != allocation_trace_version) {
+        throw std::runtime_error("Not an allocation trace");
+    }
+
+    auto read_varint = [&in]() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            int byte = in.get();
+            if (byte == std::char_traits<char>::eof()) {
+                throw std::runtime_error("Truncated allocation trace");
+            }
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Corrupted allocation trace");
+    };
+
+    std::vector<AllocationEvent> events;
+    uint64_t time_ns = 0;
+    int head;
+    while ((head = in.get()) != std::char_traits<char>::eof()) {
+        AllocationEvent event;
+        event.kind = static_cast<AllocationEvent::Kind>((head >> 7) & 1);
+        event.alignment = size_t(1) << (head & 0x3f);
+        time_ns += read_varint();
+        event.time_ns = time_ns;
+        event.id = read_varint();
+        event.size = read_varint();
+        events.push_back(event);
+    }
+    return events;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "queue.hpp"
+
+enum class ShardProbe {
+    RoundRobin,
+    Random
+};
+
+// Очередь с ослабленным FIFO: несколько шардов, у каждого свой мьютекс,
+// свой BlockMemoryResource и своя Queue<T>. Поток кладёт в "свой" шард
+// (выбирается по номеру потока), а забирает сначала из своего, затем
+// обходит остальные по кругу или со случайного места. Порядок сохраняется
+// внутри шарда, поэтому элементы одного производителя выходят в том порядке,
+// в каком были положены; между производителями порядок не гарантируется.
+template<typename T>
+class ShardedQueue {
+private:
+    struct alignas(queue_cache_line_size) Shard {
+        std::mutex mutex;
+        BlockMemoryResource resource;
+        Queue<T> queue;
+        // Размер без блокировки, чтобы пропускать пустые шарды при обходе
+        std::atomic<size_t> approx_size;
+
+        Shard() : queue(&resource), approx_size(0) {}
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t count;
+    ShardProbe probe;
+
+    static size_t thread_token() {
+        static std::atomic<size_t> next_token{0};
+        thread_local const size_t token = next_token.fetch_add(1, std::memory_order_relaxed);
+        return token;
+    }
+
+    static uint64_t next_random() {
+        thread_local uint64_t state = 0x9e3779b97f4a7c15ULL ^ (thread_token() + 1) * 0xbf58476d1ce4e5b9ULL;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    std::optional<T> pop_from(Shard& shard) {
+        if (shard.approx_size.load(std::memory_order_relaxed) == 0) {
+            return std::nullopt;
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::optional<T> value = shard.queue.try_pop();
+        if (value) {
+            shard.approx_size.store(shard.queue.size(), std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+public:
+    explicit ShardedQueue(size_t shard_count = std::max(1u, std::thread::hardware_concurrency()),
+                          ShardProbe probe_policy = ShardProbe::RoundRobin)
+        : shards(nullptr), count(shard_count), probe(probe_policy) {
+        if (shard_count == 0) {
+            throw std::invalid_argument("ShardedQueue needs at least one shard");
+        }
+        shards = std::make_unique<Shard[]>(shard_count);
+    }
+
+    ShardedQueue(const ShardedQueue&) = delete;
+    ShardedQueue& operator=(const ShardedQueue&) = delete;
+
+    // Шард, в который пишет и из которого первым читает текущий поток
+    size_t home_shard() const {
+        return thread_token() % count;
+    }
+
+    void push(T value) {
+        push_to(home_shard(), std::move(value));
+    }
+
+    void push_to(size_t shard_index, T value) {
+        Shard& shard = shards[shard_index % count];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.queue.push(std::move(value));
+        shard.approx_size.store(shard.queue.size(), std::memory_order_relaxed);
+    }
+
+    std::optional<T> try_pop() {
+        size_t home = home_shard();
+        if (std::optional<T> value = pop_from(shards[home])) {
+            return value;
+        }
+        size_t start = probe == ShardProbe::Random ? static_cast<size_t>(next_random() % count) : home + 1;
+        for (size_t i = 0; i < count; ++i) {
+            size_t index = (start + i) % count;
+            if (index == home) {
+                continue;
+            }
+            if (std::optional<T> value = pop_from(shards[index])) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Оценка без блокировок; точна, только когда очередь никто не меняет
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) {
+            total += shards[i].approx_size.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t shard_count() const {
+        return count;
+    }
+
+    size_t shard_size(size_t shard_index) const {
+        return shards[shard_index % count].approx_size.load(std::memory_order_relaxed);
+    }
+
+    ShardProbe probe_policy() const {
+        return probe;
+    }
+};
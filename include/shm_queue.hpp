@@ -0,0 +1,350 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "persistent_queue.hpp"
+
+// Очередь между процессами в сегменте POSIX shared memory. Узлы, список
+// свободных блоков и управляющий блок с мьютексом и условной переменной
+// (PTHREAD_PROCESS_SHARED) лежат в самом сегменте, ссылки - смещения,
+// поэтому каждый процесс может отобразить сегмент по своему адресу.
+// Производитель пишет элемент прямо в узел сегмента, потребитель читает его
+// оттуда же - без сокетов и промежуточных буферов.
+template<typename T>
+class ShmQueue {
+private:
+    static_assert(std::is_trivially_copyable_v<T>, "ShmQueue requires trivially copyable T");
+
+    using node_type = PersistentQueueNode<T>;
+
+    static constexpr uint64_t root_magic = 0x53484d5155455545ULL;
+
+    struct Control {
+        pthread_mutex_t mutex;
+        pthread_cond_t not_empty;
+        pthread_cond_t not_full;
+        uint64_t node_size;
+        uint64_t value_size;
+        uint64_t value_alignment;
+        uint64_t head;
+        uint64_t tail;
+        uint64_t size;
+        uint32_t closed;
+        // Сколько раз мьютекс достался после смерти владельца
+        uint64_t owner_deaths;
+    };
+
+    struct Root {
+        uint64_t magic;
+        uint64_t control;
+    };
+
+    static_assert(sizeof(Root) <= MappedFileMemoryResource::root_size);
+
+    std::unique_ptr<MappedFileMemoryResource> mr;
+    Control* control;
+    bool owner;
+
+    node_type* node(uint64_t offset) const {
+        return static_cast<node_type*>(mr->pointer_at(offset));
+    }
+
+    [[noreturn]] static void throw_error(int code, const char* what) {
+        throw std::system_error(code, std::generic_category(), what);
+    }
+
+    static void check(int code, const char* what) {
+        if (code != 0) {
+            throw_error(code, what);
+        }
+    }
+
+    // Процесс мог умереть с мьютексом посреди push или unlink_front, которые
+    // меняют несколько полей: next хвоста, head, tail, size и список
+    // свободных блоков ресурса. Каждая ссылка цепочки (head и next) и
+    // голова списка свободных меняются одной записью, поэтому цепочка от
+    // головы всегда цела, а tail и size пересчитываются по ней. Узел,
+    // выделенный или снятый умершим процессом и не возвращённый в ресурс,
+    // теряется - это утечка места в сегменте, но не порча очереди.
+    static void repair(Control* control, const MappedFileMemoryResource& mr) {
+        uint64_t last = 0;
+        uint64_t count = 0;
+        for (uint64_t offset = control->head; offset; 
+             offset = static_cast<node_type*>(mr.pointer_at(offset))->next) {
+            last = offset;
+            ++count;
+        }
+        control->tail = last;
+        control->size = count;
+    }
+
+    // Вызывается при EOWNERDEAD, мьютекс уже захвачен
+    static int make_consistent(Control* control, const MappedFileMemoryResource& mr) {
+        repair(control, mr);
+        ++control->owner_deaths;
+        return pthread_mutex_consistent(&control->mutex);
+    }
+
+    class Lock {
+    private:
+        pthread_mutex_t* mutex;
+
+    public:
+        Lock(Control* control, const MappedFileMemoryResource& mr) : mutex(&control->mutex) {
+            int rc = pthread_mutex_lock(mutex);
+            if (rc == EOWNERDEAD) {
+                rc = make_consistent(control, mr);
+            }
+            check(rc, "pthread_mutex_lock");
+        }
+
+        ~Lock() {
+            pthread_mutex_unlock(mutex);
+        }
+
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+
+    void wait(pthread_cond_t* cond) {
+        int rc = pthread_cond_wait(cond, &control->mutex);
+        if (rc == EOWNERDEAD) {
+            rc = make_consistent(control, *mr);
+        }
+        check(rc, "pthread_cond_wait");
+    }
+
+    // false - истёк таймаут
+    bool wait_until(pthread_cond_t* cond, const timespec& deadline) {
+        int rc = pthread_cond_timedwait(cond, &control->mutex, &deadline);
+        if (rc == ETIMEDOUT) {
+            return false;
+        }
+        if (rc == EOWNERDEAD) {
+            rc = make_consistent(control, *mr);
+        }
+        check(rc, "pthread_cond_timedwait");
+        return true;
+    }
+
+    void initialize() {
+        Root* root = static_cast<Root*>(mr->root());
+        void* memory = mr->allocate(sizeof(Control), alignof(Control));
+        control = ::new (memory) Control{};
+        control->node_size = sizeof(node_type);
+        control->value_size = sizeof(T);
+        control->value_alignment = alignof(T);
+
+        pthread_mutexattr_t mutex_attr;
+        pthread_mutexattr_init(&mutex_attr);
+        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+        check(pthread_mutex_init(&control->mutex, &mutex_attr), "pthread_mutex_init");
+        pthread_mutexattr_destroy(&mutex_attr);
+
+        pthread_condattr_t cond_attr;
+        pthread_condattr_init(&cond_attr);
+        pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+        check(pthread_cond_init(&control->not_empty, &cond_attr), "pthread_cond_init");
+        check(pthread_cond_init(&control->not_full, &cond_attr), "pthread_cond_init");
+        pthread_condattr_destroy(&cond_attr);
+
+        root->control = mr->offset_of(control);
+        std::atomic_ref<uint64_t>(root->magic).store(root_magic, std::memory_order_release);
+    }
+
+    // Создатель мог ещё не дойти до initialize(): ждём публикации magic
+    void attach() {
+        Root* root = static_cast<Root*>(mr->root());
+        std::atomic_ref<uint64_t> magic(root->magic);
+        auto deadline = std::chrono::steady_clock::now() + MappedFileMemoryResource::attach_timeout;
+        while (magic.load(std::memory_order_acquire) == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (magic.load(std::memory_order_acquire) != root_magic) {
+            throw std::runtime_error("Shared memory segment holds no queue");
+        }
+        control = static_cast<Control*>(mr->pointer_at(root->control));
+        // Узлы разных типов бывают одного размера, поэтому тип сверяется и по T
+        if (control->node_size != sizeof(node_type) || control->value_size != sizeof(T) ||
+            control->value_alignment != alignof(T)) {
+            throw std::runtime_error("Shared memory segment holds a queue of another type");
+        }
+    }
+
+    T unlink_front() {
+        node_type* first = node(control->head);
+        T value = first->data;
+        control->head = first->next;
+        if (!control->head) {
+            control->tail = 0;
+        }
+        --control->size;
+        mr->deallocate(first, sizeof(node_type), alignof(node_type));
+        pthread_cond_signal(&control->not_full);
+        return value;
+    }
+
+public:
+    // Создаёт сегмент name ёмкостью capacity байт или подключается к уже
+    // существующему (capacity тогда не используется). Подключающийся ждёт,
+    // пока создатель разметит сегмент, и сам его не инициализирует.
+    ShmQueue(const std::string& name, size_t capacity) : control(nullptr), owner(false) {
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            owner = true;
+        } else if (errno == EEXIST) {
+            fd = shm_open(name.c_str(), O_RDWR, 0600);
+        }
+        if (fd < 0) {
+            throw_error(errno, "shm_open");
+        }
+        try {
+            mr = std::make_unique<MappedFileMemoryResource>(
+                fd, capacity,
+                owner ? MappedFileMemoryResource::OpenMode::Create : MappedFileMemoryResource::OpenMode::Attach);
+            if (owner) {
+                initialize();
+            } else {
+                attach();
+            }
+        } catch (...) {
+            if (owner) {
+                shm_unlink(name.c_str());
+            }
+            throw;
+        }
+    }
+
+    ShmQueue(const ShmQueue&) = delete;
+    ShmQueue& operator=(const ShmQueue&) = delete;
+
+    // Имя удаляется явно: сегмент живёт, пока его не отпустят все процессы
+    static void unlink(const std::string& name) {
+        shm_unlink(name.c_str());
+    }
+
+    // true, если этот объект создал сегмент
+    bool created() const {
+        return owner;
+    }
+
+    // Если места в сегменте нет, ждёт, пока потребитель освободит узел
+    void push(const T& value) {
+        Lock lock(control, *mr);
+        node_type* new_node = nullptr;
+        while (!new_node) {
+            if (control->closed) {
+                throw std::runtime_error("Queue is closed");
+            }
+            try {
+                new_node = static_cast<node_type*>(mr->allocate(sizeof(node_type), alignof(node_type)));
+            } catch (const std::bad_alloc&) {
+                if (control->size == 0) {
+                    throw;
+                }
+                wait(&control->not_full);
+            }
+        }
+        new_node->data = value;
+        new_node->next = 0;
+
+        uint64_t offset = mr->offset_of(new_node);
+        if (control->tail) {
+            node(control->tail)->next = offset;
+        } else {
+            control->head = offset;
+        }
+        control->tail = offset;
+        ++control->size;
+        pthread_cond_signal(&control->not_empty);
+    }
+
+    std::optional<T> try_pop() {
+        Lock lock(control, *mr);
+        if (!control->head) {
+            return std::nullopt;
+        }
+        return unlink_front();
+    }
+
+    // Ждёт элемента; nullopt - очередь закрыта и пуста
+    std::optional<T> pop() {
+        Lock lock(control, *mr);
+        while (!control->head && !control->closed) {
+            wait(&control->not_empty);
+        }
+        if (!control->head) {
+            return std::nullopt;
+        }
+        return unlink_front();
+    }
+
+    template<typename Rep, typename Period>
+    std::optional<T> pop_for(std::chrono::duration<Rep, Period> timeout) {
+        timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+        deadline.tv_sec += static_cast<time_t>(ns / 1000000000);
+        deadline.tv_nsec += static_cast<long>(ns % 1000000000);
+        if (deadline.tv_nsec >= 1000000000) {
+            ++deadline.tv_sec;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        Lock lock(control, *mr);
+        while (!control->head && !control->closed) {
+            if (!wait_until(&control->not_empty, deadline)) {
+                break;
+            }
+        }
+        if (!control->head) {
+            return std::nullopt;
+        }
+        return unlink_front();
+    }
+
+    // Будит всех ждущих; новые push бросают, оставшиеся элементы можно забрать
+    void close() {
+        Lock lock(control, *mr);
+        control->closed = 1;
+        pthread_cond_broadcast(&control->not_empty);
+        pthread_cond_broadcast(&control->not_full);
+    }
+
+    bool is_closed() const {
+        Lock lock(control, *mr);
+        return control->closed != 0;
+    }
+
+    size_t size() const {
+        Lock lock(control, *mr);
+        return control->size;
+    }
+
+    // Сколько раз очередь чинилась после процесса, умершего с мьютексом
+    size_t recovered_owner_deaths() const {
+        Lock lock(control, *mr);
+        return control->owner_deaths;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+};
@@ -0,0 +1,502 @@
+#pragma once
+
+#include "queue.hpp"
+#include "soa_queue.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define QUEUE_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define QUEUE_SIMD_X86 0
+#endif
+
+// Векторные find/count/sum/min-max по непрерывным отрезкам. Для int32_t и
+// double есть SSE2 и AVX2 версии, набор выбирается один раз при первом
+// вызове по __builtin_cpu_supports; остальные арифметические типы и
+// не-x86 сборки идут через скалярные циклы.
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+inline SimdLevel simd_detect_level() {
+#if QUEUE_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    return SimdLevel::Sse2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+inline SimdLevel& simd_active_level() {
+    static SimdLevel level = simd_detect_level();
+    return level;
+}
+
+inline SimdLevel simd_level() {
+    return simd_active_level();
+}
+
+// Понижает набор инструкций (например, чтобы сравнить ядра между собой);
+// выше поддерживаемого процессором поднять нельзя
+inline void simd_set_level(SimdLevel level) {
+    simd_active_level() = std::min(level, simd_detect_level());
+}
+
+template<typename T>
+using simd_sum_type = std::conditional_t<std::is_floating_point_v<T>, double,
+                      std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+struct SimdScalarKernels {
+    template<typename T>
+    static size_t find(std::span<const T> data, T value) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return data.size();
+    }
+
+    template<typename T>
+    static size_t count(std::span<const T> data, T value) {
+        size_t result = 0;
+        for (T v : data) {
+            result += v == value;
+        }
+        return result;
+    }
+
+    template<typename T>
+    static simd_sum_type<T> sum(std::span<const T> data) {
+        simd_sum_type<T> result = 0;
+        for (T v : data) {
+            result += v;
+        }
+        return result;
+    }
+
+    template<typename T>
+    static std::pair<T, T> min_max(std::span<const T> data) {
+        T lo = data[0];
+        T hi = data[0];
+        for (T v : data) {
+            lo = v < lo ? v : lo;
+            hi = hi < v ? v : hi;
+        }
+        return {lo, hi};
+    }
+};
+
+#if QUEUE_SIMD_X86
+
+struct SimdSse2Kernels {
+    static size_t find(std::span<const int32_t> data, int32_t value) {
+        const __m128i needle = _mm_set1_epi32(value);
+        size_t i = 0;
+        for (; i + 4 <= data.size(); i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, needle)));
+            if (mask) {
+                return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + SimdScalarKernels::find(data.subspan(i), value);
+    }
+
+    static size_t find(std::span<const double> data, double value) {
+        const __m128d needle = _mm_set1_pd(value);
+        size_t i = 0;
+        for (; i + 2 <= data.size(); i += 2) {
+            int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data.data() + i), needle));
+            if (mask) {
+                return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + SimdScalarKernels::find(data.subspan(i), value);
+    }
+
+    // Счётчики в дорожках 32-битные, поэтому сбрасываем их каждые 2^20 итераций
+    static size_t count(std::span<const int32_t> data, int32_t value) {
+        const __m128i needle = _mm_set1_epi32(value);
+        size_t result = 0;
+        size_t i = 0;
+        while (i + 4 <= data.size()) {
+            __m128i acc = _mm_setzero_si128();
+            size_t stop = std::min(data.size() & ~size_t(3), i + (size_t(4) << 20));
+            for (; i < stop; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+                acc = _mm_sub_epi32(acc, _mm_cmpeq_epi32(v, needle));
+            }
+            alignas(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            result += size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+        return result + SimdScalarKernels::count(data.subspan(i), value);
+    }
+
+    static size_t count(std::span<const double> data, double value) {
+        // Маска совпадения в дорожке равна -1, вычитаем её из 64-битных счётчиков
+        const __m128d needle = _mm_set1_pd(value);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= data.size(); i += 2) {
+            __m128d eq = _mm_cmpeq_pd(_mm_loadu_pd(data.data() + i), needle);
+            acc = _mm_sub_epi64(acc, _mm_castpd_si128(eq));
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        return lanes[0] + lanes[1] + SimdScalarKernels::count(data.subspan(i), value);
+    }
+
+    static int64_t sum(std::span<const int32_t> data) {
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= data.size(); i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+            __m128i sign = _mm_srai_epi32(v, 31);
+            acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+            acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+        }
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        return lanes[0] + lanes[1] + SimdScalarKernels::sum(data.subspan(i));
+    }
+
+    static double sum(std::span<const double> data) {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= data.size(); i += 4) {
+            acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data.data() + i));
+            acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data.data() + i + 2));
+        }
+        alignas(16) double lanes[2];
+        _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+        return lanes[0] + lanes[1] + SimdScalarKernels::sum(data.subspan(i));
+    }
+
+    // В SSE2 нет pminsd/pmaxsd, выбираем через маску сравнения
+    static std::pair<int32_t, int32_t> min_max(std::span<const int32_t> data) {
+        if (data.size() < 4) {
+            return SimdScalarKernels::min_max(data);
+        }
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data()));
+        __m128i hi = lo;
+        size_t i = 4;
+        for (; i + 4 <= data.size(); i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+            __m128i less = _mm_cmplt_epi32(v, lo);
+            lo = _mm_or_si128(_mm_and_si128(less, v), _mm_andnot_si128(less, lo));
+            __m128i greater = _mm_cmpgt_epi32(v, hi);
+            hi = _mm_or_si128(_mm_and_si128(greater, v), _mm_andnot_si128(greater, hi));
+        }
+        alignas(16) int32_t lo_lanes[4];
+        alignas(16) int32_t hi_lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lo_lanes), lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(hi_lanes), hi);
+        int32_t result_lo = *std::min_element(lo_lanes, lo_lanes + 4);
+        int32_t result_hi = *std::max_element(hi_lanes, hi_lanes + 4);
+        for (; i < data.size(); ++i) {
+            result_lo = std::min(result_lo, data[i]);
+            result_hi = std::max(result_hi, data[i]);
+        }
+        return {result_lo, result_hi};
+    }
+
+    static std::pair<double, double> min_max(std::span<const double> data) {
+        if (data.size() < 2) {
+            return SimdScalarKernels::min_max(data);
+        }
+        __m128d lo = _mm_loadu_pd(data.data());
+        __m128d hi = lo;
+        size_t i = 2;
+        for (; i + 2 <= data.size(); i += 2) {
+            __m128d v = _mm_loadu_pd(data.data() + i);
+            lo = _mm_min_pd(v, lo);
+            hi = _mm_max_pd(v, hi);
+        }
+        alignas(16) double lo_lanes[2];
+        alignas(16) double hi_lanes[2];
+        _mm_store_pd(lo_lanes, lo);
+        _mm_store_pd(hi_lanes, hi);
+        double result_lo = std::min(lo_lanes[0], lo_lanes[1]);
+        double result_hi = std::max(hi_lanes[0], hi_lanes[1]);
+        if (i < data.size()) {
+            result_lo = std::min(result_lo, data[i]);
+            result_hi = std::max(result_hi, data[i]);
+        }
+        return {result_lo, result_hi};
+    }
+};
+
+#define QUEUE_SIMD_AVX2 __attribute__((target("avx2")))
+
+struct SimdAvx2Kernels {
+    QUEUE_SIMD_AVX2 static size_t find(std::span<const int32_t> data, int32_t value) {
+        const __m256i needle = _mm256_set1_epi32(value);
+        size_t i = 0;
+        for (; i + 8 <= data.size(); i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + i));
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle)));
+            if (mask) {
+                return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + SimdScalarKernels::find(data.subspan(i), value);
+    }
+
+    QUEUE_SIMD_AVX2 static size_t find(std::span<const double> data, double value) {
+        const __m256d needle = _mm256_set1_pd(value);
+        size_t i = 0;
+        for (; i + 4 <= data.size(); i += 4) {
+            int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data.data() + i), needle, _CMP_EQ_OQ));
+            if (mask) {
+                return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + SimdScalarKernels::find(data.subspan(i), value);
+    }
+
+    QUEUE_SIMD_AVX2 static size_t count(std::span<const int32_t> data, int32_t value) {
+        const __m256i needle = _mm256_set1_epi32(value);
+        size_t result = 0;
+        size_t i = 0;
+        while (i + 8 <= data.size()) {
+            __m256i acc = _mm256_setzero_si256();
+            size_t stop = std::min(data.size() & ~size_t(7), i + (size_t(8) << 20));
+            for (; i < stop; i += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + i));
+                acc = _mm256_sub_epi32(acc, _mm256_cmpeq_epi32(v, needle));
+            }
+            alignas(32) uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+            for (uint32_t lane : lanes) {
+                result += lane;
+            }
+        }
+        return result + SimdScalarKernels::count(data.subspan(i), value);
+    }
+
+    QUEUE_SIMD_AVX2 static size_t count(std::span<const double> data, double value) {
+        const __m256d needle = _mm256_set1_pd(value);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= data.size(); i += 4) {
+            __m256d eq = _mm256_cmp_pd(_mm256_loadu_pd(data.data() + i), needle, _CMP_EQ_OQ);
+            acc = _mm256_sub_epi64(acc, _mm256_castpd_si256(eq));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SimdScalarKernels::count(data.subspan(i), value);
+    }
+
+    QUEUE_SIMD_AVX2 static int64_t sum(std::span<const int32_t> data) {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= data.size(); i += 8) {
+            const __m128i* p = reinterpret_cast<const __m128i*>(data.data() + i);
+            acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm_loadu_si128(p)));
+            acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm_loadu_si128(p + 1)));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SimdScalarKernels::sum(data.subspan(i));
+    }
+
+    QUEUE_SIMD_AVX2 static double sum(std::span<const double> data) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= data.size(); i += 8) {
+            acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data.data() + i));
+            acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data.data() + i + 4));
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SimdScalarKernels::sum(data.subspan(i));
+    }
+
+    QUEUE_SIMD_AVX2 static std::pair<int32_t, int32_t> min_max(std::span<const int32_t> data) {
+        if (data.size() < 8) {
+            return SimdScalarKernels::min_max(data);
+        }
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data()));
+        __m256i hi = lo;
+        size_t i = 8;
+        for (; i + 8 <= data.size(); i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + i));
+            lo = _mm256_min_epi32(lo, v);
+            hi = _mm256_max_epi32(hi, v);
+        }
+        alignas(32) int32_t lo_lanes[8];
+        alignas(32) int32_t hi_lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lo_lanes), lo);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(hi_lanes), hi);
+        int32_t result_lo = *std::min_element(lo_lanes, lo_lanes + 8);
+        int32_t result_hi = *std::max_element(hi_lanes, hi_lanes + 8);
+        for (; i < data.size(); ++i) {
+            result_lo = std::min(result_lo, data[i]);
+            result_hi = std::max(result_hi, data[i]);
+        }
+        return {result_lo, result_hi};
+    }
+
+    QUEUE_SIMD_AVX2 static std::pair<double, double> min_max(std::span<const double> data) {
+        if (data.size() < 4) {
+            return SimdScalarKernels::min_max(data);
+        }
+        __m256d lo = _mm256_loadu_pd(data.data());
+        __m256d hi = lo;
+        size_t i = 4;
+        for (; i + 4 <= data.size(); i += 4) {
+            __m256d v = _mm256_loadu_pd(data.data() + i);
+            lo = _mm256_min_pd(v, lo);
+            hi = _mm256_max_pd(v, hi);
+        }
+        alignas(32) double lo_lanes[4];
+        alignas(32) double hi_lanes[4];
+        _mm256_store_pd(lo_lanes, lo);
+        _mm256_store_pd(hi_lanes, hi);
+        double result_lo = *std::min_element(lo_lanes, lo_lanes + 4);
+        double result_hi = *std::max_element(hi_lanes, hi_lanes + 4);
+        for (; i < data.size(); ++i) {
+            result_lo = std::min(result_lo, data[i]);
+            result_hi = std::max(result_hi, data[i]);
+        }
+        return {result_lo, result_hi};
+    }
+};
+
+#undef QUEUE_SIMD_AVX2
+
+#endif
+
+template<typename T>
+constexpr bool simd_has_vector_kernels = QUEUE_SIMD_X86 &&
+    (std::is_same_v<T, int32_t> || std::is_same_v<T, double>);
+
+// Выбирает набор ядер по текущему уровню и вызывает call(Kernels{})
+template<typename T, typename Call>
+inline decltype(auto) simd_dispatch(Call&& call) {
+#if QUEUE_SIMD_X86
+    if constexpr (simd_has_vector_kernels<T>) {
+        switch (simd_level()) {
+            case SimdLevel::Avx2:
+                return call(SimdAvx2Kernels{});
+            case SimdLevel::Sse2:
+                return call(SimdSse2Kernels{});
+            case SimdLevel::Scalar:
+                break;
+        }
+    }
+#endif
+    return call(SimdScalarKernels{});
+}
+
+// Ядра по отрезку. find возвращает индекс первого совпадения или data.size()
+template<typename T>
+    requires std::is_arithmetic_v<T>
+size_t simd_find(std::span<const T> data, T value) {
+    return simd_dispatch<T>([&](auto kernels) -> size_t { return kernels.find(data, value); });
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+size_t simd_count(std::span<const T> data, T value) {
+    return simd_dispatch<T>([&](auto kernels) -> size_t { return kernels.count(data, value); });
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+simd_sum_type<T> simd_sum(std::span<const T> data) {
+    return simd_dispatch<T>([&](auto kernels) -> simd_sum_type<T> { return kernels.sum(data); });
+}
+
+// Отрезок не должен быть пустым
+template<typename T>
+    requires std::is_arithmetic_v<T>
+std::pair<T, T> simd_min_max(std::span<const T> data) {
+    return simd_dispatch<T>([&](auto kernels) -> std::pair<T, T> { return kernels.min_max(data); });
+}
+
+// Те же операции над очередью: Queue<T> и SoaQueue<T> отдают содержимое
+// через for_each_chunk. find возвращает позицию от головы или size().
+template<typename Q>
+struct simd_queue_element {
+    using type = typename Q::value_type;
+};
+
+template<typename T, typename Alloc>
+struct simd_queue_element<Queue<T, Alloc>> {
+    using type = T;
+};
+
+template<typename T>
+struct simd_queue_element<SoaQueue<T>> {
+    using type = T;
+};
+
+template<typename Q>
+using simd_queue_element_t = typename simd_queue_element<Q>::type;
+
+template<typename Q>
+size_t queue_find(const Q& q, simd_queue_element_t<Q> value) {
+    using T = simd_queue_element_t<Q>;
+    size_t offset = 0;
+    size_t found = q.size();
+    q.for_each_chunk([&](std::span<const T> chunk) {
+        size_t i = simd_find(chunk, value);
+        if (i != chunk.size()) {
+            found = offset + i;
+            return false;
+        }
+        offset += chunk.size();
+        return true;
+    });
+    return found;
+}
+
+template<typename Q>
+size_t queue_count(const Q& q, simd_queue_element_t<Q> value) {
+    using T = simd_queue_element_t<Q>;
+    size_t result = 0;
+    q.for_each_chunk([&](std::span<const T> chunk) { result += simd_count(chunk, value); });
+    return result;
+}
+
+template<typename Q>
+simd_sum_type<simd_queue_element_t<Q>> queue_sum(const Q& q) {
+    using T = simd_queue_element_t<Q>;
+    simd_sum_type<T> result = 0;
+    q.for_each_chunk([&](std::span<const T> chunk) { result += simd_sum(chunk); });
+    return result;
+}
+
+template<typename Q>
+std::pair<simd_queue_element_t<Q>, simd_queue_element_t<Q>> queue_min_max(const Q& q) {
+    using T = simd_queue_element_t<Q>;
+    if (q.empty()) [[unlikely]] {
+        throw_queue_empty();
+    }
+    std::pair<T, T> result{};
+    bool first = true;
+    q.for_each_chunk([&](std::span<const T> chunk) {
+        auto [lo, hi] = simd_min_max(chunk);
+        result.first = first || lo < result.first ? lo : result.first;
+        result.second = first || result.second < hi ? hi : result.second;
+        first = false;
+    });
+    return result;
+}
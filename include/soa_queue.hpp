@@ -0,0 +1,366 @@
+#pragma once
+
+#include "queue.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <tuple>
+#include <utility>
+
+// FIFO-очередь с раскладкой struct-of-arrays: каждое поле записи лежит в
+// своей колонке. Колонки нарезаны кусками по chunk_capacity элементов, все
+// колонки одного куска выделяются одним блоком из memory_resource. Скан по
+// одному полю идёт по непрерывным массивам, см. for_each_chunk.
+template<typename... Fields>
+class SoaQueue {
+    static_assert(sizeof...(Fields) > 0, "SoaQueue needs at least one field");
+
+public:
+    static constexpr size_t field_count = sizeof...(Fields);
+    static constexpr size_t chunk_capacity = 1024;
+
+    template<size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+
+private:
+    struct Chunk {
+        Chunk* next;
+    };
+
+    static constexpr size_t column_alignment = queue_cache_line_size;
+
+    static constexpr size_t align_to(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Смещения колонок от начала куска; каждая колонка с начала кэш-линии
+    static constexpr std::array<size_t, field_count + 1> compute_layout() {
+        constexpr std::array<size_t, field_count> sizes{sizeof(Fields)...};
+        constexpr std::array<size_t, field_count> alignments{alignof(Fields)...};
+        std::array<size_t, field_count + 1> layout{};
+        size_t offset = sizeof(Chunk);
+        for (size_t i = 0; i < field_count; ++i) {
+            offset = align_to(offset, std::max(alignments[i], column_alignment));
+            layout[i] = offset;
+            offset += sizes[i] * chunk_capacity;
+        }
+        layout[field_count] = align_to(offset, column_alignment);
+        return layout;
+    }
+
+    static constexpr std::array<size_t, field_count + 1> layout = compute_layout();
+    static constexpr size_t chunk_bytes = layout[field_count];
+    static constexpr size_t chunk_alignment = std::max({column_alignment, alignof(Chunk), alignof(Fields)...});
+
+    Chunk* head = nullptr;
+    Chunk* tail = nullptr;
+    Chunk* spare = nullptr;
+    size_t head_index = 0;
+    size_t tail_count = 0;
+    size_t size_ = 0;
+    std::pmr::memory_resource* resource;
+
+    template<size_t I>
+    static field_type<I>* column(Chunk* chunk) {
+        return std::launder(reinterpret_cast<field_type<I>*>(reinterpret_cast<char*>(chunk) + layout[I]));
+    }
+
+    Chunk* allocate_chunk() {
+        if (spare) {
+            return std::exchange(spare, nullptr);
+        }
+        return ::new (resource->allocate(chunk_bytes, chunk_alignment)) Chunk{nullptr};
+    }
+
+    // Один пустой кусок держим в запасе, чтобы push/pop на границе куска
+    // не гоняли память через resource
+    void release_chunk(Chunk* chunk) {
+        if (spare) {
+            resource->deallocate(chunk, chunk_bytes, chunk_alignment);
+        } else {
+            spare = chunk;
+        }
+    }
+
+    template<size_t... I>
+    static void destroy_slot(Chunk* chunk, size_t slot, size_t constructed, std::index_sequence<I...>) {
+        ((I < constructed ? std::destroy_at(column<I>(chunk) + slot) : void()), ...);
+    }
+
+    template<size_t... I, typename... Args>
+    static void construct_slot(Chunk* chunk, size_t slot, std::index_sequence<I...> seq, Args&&... args) {
+        size_t constructed = 0;
+        try {
+            ((::new (static_cast<void*>(column<I>(chunk) + slot)) field_type<I>(std::forward<Args>(args)), ++constructed), ...);
+        } catch (...) {
+            destroy_slot(chunk, slot, constructed, seq);
+            throw;
+        }
+    }
+
+    template<size_t... I>
+    static reference row(Chunk* chunk, size_t slot, std::index_sequence<I...>) {
+        return reference(column<I>(chunk)[slot]...);
+    }
+
+    template<size_t... I>
+    static value_type take_row(Chunk* chunk, size_t slot, std::index_sequence<I...>) {
+        return value_type(std::move(column<I>(chunk)[slot])...);
+    }
+
+    template<typename... Args>
+    void emplace_back_slot(Args&&... args) {
+        if (!tail || tail_count == chunk_capacity) {
+            Chunk* chunk = allocate_chunk();
+            chunk->next = nullptr;
+            try {
+                construct_slot(chunk, 0, std::index_sequence_for<Fields...>{}, std::forward<Args>(args)...);
+            } catch (...) {
+                release_chunk(chunk);
+                throw;
+            }
+            if (tail) {
+                tail->next = chunk;
+            } else {
+                head = chunk;
+                head_index = 0;
+            }
+            tail = chunk;
+            tail_count = 1;
+        } else {
+            construct_slot(tail, tail_count, std::index_sequence_for<Fields...>{}, std::forward<Args>(args)...);
+            ++tail_count;
+        }
+        ++size_;
+    }
+
+    void drop_front() {
+        destroy_slot(head, head_index, field_count, std::index_sequence_for<Fields...>{});
+        ++head_index;
+        --size_;
+        if (size_ == 0) {
+            // Очередь опустела внутри последнего куска: начинаем его заново
+            head_index = 0;
+            tail_count = 0;
+        } else if (head_index == chunk_capacity) {
+            Chunk* old = head;
+            head = head->next;
+            head_index = 0;
+            release_chunk(old);
+        }
+    }
+
+    void free_chunks() {
+        clear();
+        if (head) {
+            resource->deallocate(head, chunk_bytes, chunk_alignment);
+        }
+        if (spare) {
+            resource->deallocate(spare, chunk_bytes, chunk_alignment);
+        }
+        head = tail = spare = nullptr;
+        head_index = tail_count = 0;
+    }
+
+    void steal(SoaQueue& other) noexcept {
+        head = std::exchange(other.head, nullptr);
+        tail = std::exchange(other.tail, nullptr);
+        spare = std::exchange(other.spare, nullptr);
+        head_index = std::exchange(other.head_index, 0);
+        tail_count = std::exchange(other.tail_count, 0);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+public:
+    SoaQueue() : resource(std::pmr::get_default_resource()) {}
+
+    explicit SoaQueue(std::pmr::memory_resource* mr) : resource(mr) {}
+
+    SoaQueue(const SoaQueue& other) : resource(other.resource) {
+        try {
+            other.for_each([this](const Fields&... values) { push(values...); });
+        } catch (...) {
+            free_chunks();
+            throw;
+        }
+    }
+
+    SoaQueue(SoaQueue&& other) noexcept : resource(other.resource) {
+        steal(other);
+    }
+
+    SoaQueue& operator=(const SoaQueue& other) {
+        if (this != &other) {
+            clear();
+            other.for_each([this](const Fields&... values) { push(values...); });
+        }
+        return *this;
+    }
+
+    SoaQueue& operator=(SoaQueue&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (resource->is_equal(*other.resource)) {
+            free_chunks();
+            steal(other);
+        } else {
+            clear();
+            while (!other.empty()) {
+                push(other.pop_value());
+            }
+        }
+        return *this;
+    }
+
+    ~SoaQueue() {
+        free_chunks();
+    }
+
+    void swap(SoaQueue& other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(spare, other.spare);
+        std::swap(head_index, other.head_index);
+        std::swap(tail_count, other.tail_count);
+        std::swap(size_, other.size_);
+        std::swap(resource, other.resource);
+    }
+
+    friend void swap(SoaQueue& a, SoaQueue& b) noexcept {
+        a.swap(b);
+    }
+
+    template<typename... Args>
+        requires (sizeof...(Args) == field_count)
+    void push(Args&&... args) {
+        emplace_back_slot(std::forward<Args>(args)...);
+    }
+
+    void push(const value_type& values) {
+        std::apply([this](const Fields&... v) { emplace_back_slot(v...); }, values);
+    }
+
+    void push(value_type&& values) {
+        std::apply([this](Fields&... v) { emplace_back_slot(std::move(v)...); }, values);
+    }
+
+    void pop() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        drop_front();
+    }
+
+    value_type pop_value() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        value_type result = take_row(head, head_index, std::index_sequence_for<Fields...>{});
+        drop_front();
+        return result;
+    }
+
+    reference front() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return row(head, head_index, std::index_sequence_for<Fields...>{});
+    }
+
+    reference back() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return row(tail, tail_count - 1, std::index_sequence_for<Fields...>{});
+    }
+
+    template<size_t I>
+    field_type<I>& front() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return column<I>(head)[head_index];
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    void clear() {
+        while (!empty()) {
+            drop_front();
+        }
+    }
+
+    std::pmr::memory_resource* get_memory_resource() const {
+        return resource;
+    }
+
+    // Обходит колонку I непрерывными отрезками в порядке FIFO; обработчик
+    // может вернуть false, чтобы остановить обход
+    template<size_t I, typename F>
+    void for_each_chunk(F&& f) {
+        for (Chunk* chunk = head; chunk && size_; chunk = chunk->next) {
+            size_t begin = chunk == head ? head_index : 0;
+            size_t end = chunk == tail ? tail_count : chunk_capacity;
+            if (!queue_visit_chunk(f, std::span<field_type<I>>(column<I>(chunk) + begin, end - begin))) {
+                return;
+            }
+        }
+    }
+
+    template<size_t I, typename F>
+    void for_each_chunk(F&& f) const {
+        for (Chunk* chunk = head; chunk && size_; chunk = chunk->next) {
+            size_t begin = chunk == head ? head_index : 0;
+            size_t end = chunk == tail ? tail_count : chunk_capacity;
+            if (!queue_visit_chunk(f, std::span<const field_type<I>>(column<I>(chunk) + begin, end - begin))) {
+                return;
+            }
+        }
+    }
+
+    // Для очереди из одного поля - та же сигнатура, что у Queue::for_each_chunk
+    template<typename F>
+        requires (field_count == 1)
+    void for_each_chunk(F&& f) const {
+        for_each_chunk<0>(f);
+    }
+
+    // Построчный обход: f получает все поля записи
+    template<typename F>
+    void for_each(F&& f) {
+        for_each_rows<Fields&...>(*this, f);
+    }
+
+    template<typename F>
+    void for_each(F&& f) const {
+        for_each_rows<const Fields&...>(*this, f);
+    }
+
+private:
+    template<typename... Refs, typename Self, typename F>
+    static void for_each_rows(Self& self, F& f) {
+        for (Chunk* chunk = self.head; chunk && self.size_; chunk = chunk->next) {
+            size_t begin = chunk == self.head ? self.head_index : 0;
+            size_t end = chunk == self.tail ? self.tail_count : chunk_capacity;
+            for (size_t slot = begin; slot < end; ++slot) {
+                std::apply([&f](auto&... values) { f(static_cast<Refs>(values)...); },
+                           row(chunk, slot, std::index_sequence_for<Fields...>{}));
+            }
+        }
+    }
+};
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "queue.hpp"
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+[[noreturn]] QUEUE_COLD inline void throw_static_queue_full() {
+    throw std::length_error("StaticQueue is full");
+}
+
+template<typename T, size_t N, bool IsConst = false>
+class StaticQueueIterator;
+
+// Очередь фиксированной ёмкости N на кольцевом буфере внутри объекта: ни
+// одного обращения к куче. Ячейки - объединения, поэтому T не обязан иметь
+// конструктор по умолчанию, а живыми остаются только элементы очереди. Всё,
+// включая деструктор, constexpr: таблицы можно собирать при компиляции.
+// Если N - степень двойки, индекс заворачивается маской.
+template<typename T, size_t N>
+class StaticQueue {
+    static_assert(N > 0, "StaticQueue capacity must be positive");
+
+    template<typename, size_t, bool>
+    friend class StaticQueueIterator;
+
+    union Slot {
+        char empty;
+        T value;
+
+        constexpr Slot() : empty() {}
+        constexpr ~Slot() {}
+    };
+
+    static constexpr bool power_of_two = (N & (N - 1)) == 0;
+
+    Slot slots[N];
+    size_t head = 0;
+    size_t count = 0;
+
+    static constexpr size_t wrap(size_t index) {
+        if constexpr (power_of_two) {
+            return index & (N - 1);
+        } else {
+            return index >= N ? index - N : index;
+        }
+    }
+
+    constexpr T& slot(size_t i) {
+        return slots[wrap(head + i)].value;
+    }
+
+    constexpr const T& slot(size_t i) const {
+        return slots[wrap(head + i)].value;
+    }
+
+    template<typename... Args>
+    constexpr void construct_back(Args&&... args) {
+        std::construct_at(&slots[wrap(head + count)].value, std::forward<Args>(args)...);
+        ++count;
+    }
+
+    constexpr void destroy_front() {
+        std::destroy_at(&slots[head].value);
+        head = wrap(head + 1);
+        --count;
+    }
+
+public:
+    using value_type = T;
+    using iterator = StaticQueueIterator<T, N, false>;
+    using const_iterator = StaticQueueIterator<T, N, true>;
+
+    constexpr StaticQueue() = default;
+
+    constexpr StaticQueue(std::initializer_list<T> values) {
+        for (const T& value : values) {
+            push(value);
+        }
+    }
+
+    constexpr StaticQueue(const StaticQueue& other) {
+        for (size_t i = 0; i < other.count; ++i) {
+            construct_back(other.slot(i));
+        }
+    }
+
+    constexpr StaticQueue(StaticQueue&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        for (size_t i = 0; i < other.count; ++i) {
+            construct_back(std::move(other.slot(i)));
+        }
+        other.clear();
+    }
+
+    constexpr StaticQueue& operator=(const StaticQueue& other) {
+        if (this != &other) {
+            clear();
+            for (size_t i = 0; i < other.count; ++i) {
+                construct_back(other.slot(i));
+            }
+        }
+        return *this;
+    }
+
+    constexpr StaticQueue& operator=(StaticQueue&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            clear();
+            for (size_t i = 0; i < other.count; ++i) {
+                construct_back(std::move(other.slot(i)));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    constexpr ~StaticQueue() {
+        clear();
+    }
+
+    constexpr void push(const T& value) {
+        if (full()) [[unlikely]] {
+            throw_static_queue_full();
+        }
+        construct_back(value);
+    }
+
+    constexpr void push(T&& value) {
+        if (full()) [[unlikely]] {
+            throw_static_queue_full();
+        }
+        construct_back(std::move(value));
+    }
+
+    // Вариант без исключения: false, если места нет
+    constexpr bool try_push(T value) {
+        if (full()) {
+            return false;
+        }
+        construct_back(std::move(value));
+        return true;
+    }
+
+    constexpr void pop() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        destroy_front();
+    }
+
+    constexpr T pop_value() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        T result = std::move(slot(0));
+        destroy_front();
+        return result;
+    }
+
+    constexpr std::optional<T> try_pop() {
+        if (empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> result(std::move(slot(0)));
+        destroy_front();
+        return result;
+    }
+
+    constexpr T* try_front() noexcept {
+        return empty() ? nullptr : &slot(0);
+    }
+
+    constexpr T* try_back() noexcept {
+        return empty() ? nullptr : &slot(count - 1);
+    }
+
+    constexpr T& front() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return slot(0);
+    }
+
+    constexpr const T& front() const {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return slot(0);
+    }
+
+    constexpr T& back() {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return slot(count - 1);
+    }
+
+    constexpr const T& back() const {
+        if (empty()) [[unlikely]] {
+            throw_queue_empty();
+        }
+        return slot(count - 1);
+    }
+
+    // Доступ по позиции от головы без проверки границ
+    constexpr T& operator[](size_t i) {
+        return slot(i);
+    }
+
+    constexpr const T& operator[](size_t i) const {
+        return slot(i);
+    }
+
+    constexpr bool empty() const {
+        return count == 0;
+    }
+
+    constexpr bool full() const {
+        return count == N;
+    }
+
+    constexpr size_t size() const {
+        return count;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    constexpr void clear() {
+        while (count) {
+            destroy_front();
+        }
+        head = 0;
+    }
+
+    constexpr iterator begin() { return iterator(this, 0); }
+    constexpr iterator end() { return iterator(this, count); }
+    constexpr const_iterator begin() const { return const_iterator(this, 0); }
+    constexpr const_iterator end() const { return const_iterator(this, count); }
+    constexpr const_iterator cbegin() const { return begin(); }
+    constexpr const_iterator cend() const { return end(); }
+};
+
+template<typename T, size_t N, bool IsConst>
+class StaticQueueIterator {
+    using queue_pointer = std::conditional_t<IsConst, const StaticQueue<T, N>*, StaticQueue<T, N>*>;
+
+    queue_pointer queue;
+    size_t position;
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+
+    constexpr StaticQueueIterator() : queue(nullptr), position(0) {}
+
+    constexpr StaticQueueIterator(queue_pointer q, size_t pos) : queue(q), position(pos) {}
+
+    constexpr operator StaticQueueIterator<T, N, true>() const requires (!IsConst) {
+        return StaticQueueIterator<T, N, true>(queue, position);
+    }
+
+    constexpr reference operator*() const {
+        return queue->slot(position);
+    }
+
+    constexpr pointer operator->() const {
+        return &queue->slot(position);
+    }
+
+    constexpr StaticQueueIterator& operator++() {
+        ++position;
+        return *this;
+    }
+
+    constexpr StaticQueueIterator operator++(int) {
+        StaticQueueIterator temp = *this;
+        ++position;
+        return temp;
+    }
+
+    constexpr bool operator==(const StaticQueueIterator& other) const {
+        return queue == other.queue && position == other.position;
+    }
+
+    constexpr bool operator!=(const StaticQueueIterator& other) const {
+        return !(*this == other);
+    }
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "queue.hpp"
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    Queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping;
+
+    void worker_loop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency())
+        : stopping(false) {
+        if (thread_count == 0) {
+            thread_count = 1;
+        }
+        workers.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const {
+        return workers.size();
+    }
+
+    template<typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>> {
+        using result_type = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+        std::future<result_type> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                throw std::runtime_error("ThreadPool is stopping");
+            }
+            tasks.push([task] { (*task)(); });
+        }
+        ready.notify_one();
+        return result;
+    }
+};
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "queue.hpp"
+
+// Очередь с журналом упреждающей записи. Элементы живут в обычной Queue<T>,
+// а каждый push дописывается в буфер журнала; буфер сбрасывается в файл
+// сегмента и фиксируется одним fdatasync на группу записей. Извлечения
+// сохраняются как смещение потребителя. После сбоя очередь восстанавливается
+// повторным чтением сегментов начиная с этого смещения.
+template<typename T>
+class WalQueue {
+private:
+    static_assert(std::is_trivially_copyable_v<T>, "WalQueue requires trivially copyable T");
+
+    struct RecordHeader {
+        uint32_t size;
+        uint32_t checksum;
+    };
+
+    struct Segment {
+        uint64_t first_sequence;
+        std::filesystem::path path;
+    };
+
+    Queue<T> queue;
+    std::filesystem::path directory;
+    size_t segment_bytes;
+    size_t group_size;
+
+    std::deque<Segment> segments;
+    int segment_fd;
+    size_t segment_written;
+    int offset_fd;
+
+    std::vector<char> pending;
+    size_t pending_records;
+    uint64_t next_sequence;
+    uint64_t consumed;
+    bool offset_dirty;
+
+    [[noreturn]] static void throw_errno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    static uint32_t checksum(const char* data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    static void write_all(int fd, const char* data, size_t size) {
+        while (size) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw_errno("write");
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    std::filesystem::path segment_path(uint64_t first_sequence) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%020llu.wal", static_cast<unsigned long long>(first_sequence));
+        return directory / name;
+    }
+
+    void open_segment(uint64_t first_sequence) {
+        auto path = segment_path(first_sequence);
+        segment_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (segment_fd < 0) {
+            throw_errno("open");
+        }
+        segments.push_back(Segment{first_sequence, path});
+        segment_written = 0;
+    }
+
+    void close_segment() {
+        if (segment_fd >= 0) {
+            ::close(segment_fd);
+            segment_fd = -1;
+        }
+    }
+
+    void flush_pending() {
+        if (pending.empty()) {
+            return;
+        }
+        write_all(segment_fd, pending.data(), pending.size());
+        segment_written += pending.size();
+        pending.clear();
+        pending_records = 0;
+        if (::fdatasync(segment_fd) != 0) {
+            throw_errno("fdatasync");
+        }
+    }
+
+    void write_offset() {
+        if (::pwrite(offset_fd, &consumed, sizeof(consumed), 0) != sizeof(consumed)) {
+            throw_errno("pwrite");
+        }
+        if (::fdatasync(offset_fd) != 0) {
+            throw_errno("fdatasync");
+        }
+        offset_dirty = false;
+    }
+
+    // Сегмент можно удалить, когда потребитель прошёл первую запись следующего.
+    void drop_consumed_segments() {
+        while (segments.size() > 1 && segments[1].first_sequence <= consumed) {
+            std::filesystem::remove(segments.front().path);
+            segments.pop_front();
+        }
+    }
+
+    // Читает сегмент, возвращая длину его целой части; оборванная при сбое
+    // последняя запись отбрасывается.
+    size_t replay_segment(const Segment& segment, uint64_t& sequence) {
+        int fd = ::open(segment.path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw_errno("open");
+        }
+        size_t file_size = static_cast<size_t>(std::filesystem::file_size(segment.path));
+        std::vector<char> data(file_size);
+        size_t read_total = 0;
+        while (read_total < file_size) {
+            ssize_t got = ::read(fd, data.data() + read_total, file_size - read_total);
+            if (got <= 0) {
+                break;
+            }
+            read_total += static_cast<size_t>(got);
+        }
+        ::close(fd);
+
+        size_t position = 0;
+        while (position + sizeof(RecordHeader) <= read_total) {
+            RecordHeader header;
+            std::memcpy(&header, data.data() + position, sizeof(header));
+            const char* payload = data.data() + position + sizeof(header);
+            if (header.size != sizeof(T) || position + sizeof(header) + sizeof(T) > read_total || 
+                header.checksum != checksum(payload, sizeof(T))) {
+                break;
+            }
+            if (sequence >= consumed) {
+                T value;
+                std::memcpy(&value, payload, sizeof(T));
+                queue.push(std::move(value));
+            }
+            ++sequence;
+            position += sizeof(header) + sizeof(T);
+        }
+        return position;
+    }
+
+    void recover() {
+        std::vector<Segment> found;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.path().extension() == ".wal") {
+                found.push_back(Segment{std::stoull(entry.path().stem().string()), entry.path()});
+            }
+        }
+        std::sort(found.begin(), found.end(), 
+                  [](const Segment& a, const Segment& b) { return a.first_sequence < b.first_sequence; });
+
+        uint64_t sequence = found.empty() ? consumed : found.front().first_sequence;
+        if (sequence > consumed) {
+            consumed = sequence;
+        }
+        for (const auto& segment : found) {
+            sequence = segment.first_sequence;
+            size_t valid = replay_segment(segment, sequence);
+            std::filesystem::resize_file(segment.path, valid);
+            segments.push_back(segment);
+            segment_written = valid;
+        }
+        next_sequence = sequence;
+        if (consumed > next_sequence) {
+            consumed = next_sequence;
+        }
+
+        if (segments.empty()) {
+            open_segment(next_sequence);
+        } else {
+            segment_fd = ::open(segments.back().path.c_str(), O_WRONLY | O_APPEND);
+            if (segment_fd < 0) {
+                throw_errno("open");
+            }
+        }
+        drop_consumed_segments();
+    }
+
+public:
+    WalQueue(const std::filesystem::path& dir, size_t group_commit = 64, 
+             size_t segment_size = 64 << 20, 
+             std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : queue(mr), directory(dir), segment_bytes(segment_size), group_size(group_commit ? group_commit : 1),
+          segment_fd(-1), segment_written(0), offset_fd(-1), pending_records(0), 
+          next_sequence(0), consumed(0), offset_dirty(false) {
+        std::filesystem::create_directories(directory);
+        offset_fd = ::open((directory / "consumer.offset").c_str(), O_RDWR | O_CREAT, 0644);
+        if (offset_fd < 0) {
+            throw_errno("open");
+        }
+        try {
+            if (::pread(offset_fd, &consumed, sizeof(consumed), 0) != sizeof(consumed)) {
+                consumed = 0;
+            }
+            recover();
+        } catch (...) {
+            close_segment();
+            ::close(offset_fd);
+            throw;
+        }
+    }
+
+    ~WalQueue() {
+        try {
+            commit();
+        } catch (...) {
+        }
+        close_segment();
+        ::close(offset_fd);
+    }
+
+    WalQueue(const WalQueue&) = delete;
+
+    WalQueue& operator=(const WalQueue&) = delete;
+
+    void push(const T& value) {
+        queue.push(T(value));
+
+        size_t record_size = sizeof(RecordHeader) + sizeof(T);
+        if (segment_written + pending.size() + record_size > segment_bytes && 
+            segment_written + pending.size() > 0) {
+            flush_pending();
+            close_segment();
+            open_segment(next_sequence);
+        }
+
+        RecordHeader header{static_cast<uint32_t>(sizeof(T)), 
+                            checksum(reinterpret_cast<const char*>(&value), sizeof(T))};
+        const char* header_bytes = reinterpret_cast<const char*>(&header);
+        pending.insert(pending.end(), header_bytes, header_bytes + sizeof(header));
+        const char* value_bytes = reinterpret_cast<const char*>(&value);
+        pending.insert(pending.end(), value_bytes, value_bytes + sizeof(T));
+        ++next_sequence;
+
+        if (++pending_records >= group_size) {
+            commit();
+        }
+    }
+
+    void pop() {
+        queue.pop();
+        ++consumed;
+        offset_dirty = true;
+    }
+
+    // Фиксирует все накопленные push и текущее смещение потребителя.
+    void commit() {
+        flush_pending();
+        if (offset_dirty) {
+            write_offset();
+            drop_consumed_segments();
+        }
+    }
+
+    T& front() {
+        return queue.front();
+    }
+
+    T& back() {
+        return queue.back();
+    }
+
+    bool empty() const {
+        return queue.empty();
+    }
+
+    size_t size() const {
+        return queue.size();
+    }
+
+    size_t segment_count() const {
+        return segments.size();
+    }
+
+    typename Queue<T>::iterator begin() {
+        return queue.begin();
+    }
+
+    typename Queue<T>::iterator end() {
+        return queue.end();
+    }
+};
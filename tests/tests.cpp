@@ -1,9 +1,35 @@
 #include <gtest/gtest.h>
 #include "../include/queue.hpp"
+#include "../include/parallel_algorithms.hpp"
+#include "../include/persistent_queue.hpp"
+#include "../include/wal_queue.hpp"
+#include "../include/queue_serialization.hpp"
+#include "../include/async_queue.hpp"
+#include "../include/broadcast_queue.hpp"
+#include "../include/blocking_queue.hpp"
+#include "../include/block_allocator.hpp"
+#include "../include/huge_page_memory_resource.hpp"
+#include "../include/soa_queue.hpp"
+#include "../include/simd_kernels.hpp"
+#include "../include/static_queue.hpp"
+#include "../include/sharded_queue.hpp"
+#include "../include/shm_queue.hpp"
+#include "../include/expiring_queue.hpp"
+#include "../include/recording_memory_resource.hpp"
+#include "../include/coalescing_queue.hpp"
 #include <vector>
 #include <algorithm>
 #include <string>
 #include <memory>
+#include <filesystem>
+#include <cstring>
+#include <sstream>
+#include <numeric>
+#include <thread>
+#include <atomic>
+#include <csignal>
+#include <sys/wait.h>
+#include <sys/resource.h>
 
 // Тестовая структура с несколькими полями
 struct Employee {
@@ -605,6 +631,1844 @@ TEST(QueueModificationTest, ModifyComplexObjects) {
     EXPECT_EQ(q.back().id, 3);
 }
 
+// ==================== ТЕСТЫ ИТЕРАТОРА С ПРЕДВЫБОРКОЙ ====================
+
+TEST(QueuePrefetchIteratorTest, VisitsSameElementsAsPlainIterator) {
+    Queue<int> q;
+    for (int i = 1; i <= 100; ++i) {
+        q.push(i);
+    }
+    
+    // Разные дистанции, включая большую, чем размер очереди
+    for (size_t distance : {0, 1, 8, 500}) {
+        std::vector<int> collected;
+        for (auto it = q.prefetch_begin(distance); it != q.prefetch_end(); ++it) {
+            collected.push_back(*it);
+        }
+        ASSERT_EQ(collected.size(), 100);
+        EXPECT_TRUE(std::equal(collected.begin(), collected.end(), q.begin()));
+    }
+}
+
+TEST(QueuePrefetchIteratorTest, ForEachPrefetchedWithSTL) {
+    Queue<Employee> q;
+    q.push(Employee("Alice", 1, 100.0, "IT"));
+    q.push(Employee("Bob", 2, 200.0, "HR"));
+    
+    double total = 0.0;
+    q.for_each_prefetched([&total](Employee& e) { total += e.salary; }, 4);
+    EXPECT_EQ(total, 300.0);
+    
+    auto found = std::find_if(q.prefetch_begin(), q.prefetch_end(), 
+                              [](const Employee& e) { return e.id == 2; });
+    ASSERT_NE(found, q.prefetch_end());
+    EXPECT_EQ(found->name, "Bob");
+    
+    Queue<int> empty;
+    EXPECT_EQ(empty.prefetch_begin(), empty.prefetch_end());
+}
+
+// ==================== ТЕСТЫ ПАРАЛЛЕЛЬНЫХ АЛГОРИТМОВ ====================
+
+TEST(QueueSegmentsTest, MarksFollowPushAndPop) {
+    Queue<int> q;
+    q.enable_segments(4);
+    for (int i = 0; i < 10; ++i) {
+        q.push(i);
+    }
+    
+    // 10 элементов по 4 в сегменте: 4 + 4 + 2
+    auto segments = q.segments();
+    ASSERT_EQ(segments.size(), 3);
+    EXPECT_EQ(*segments[1].first, 4);
+    EXPECT_EQ(*segments[2].first, 8);
+    EXPECT_EQ(std::distance(segments[2].first, segments[2].second), 2);
+    
+    // Извлечение первого сегмента убирает его метку
+    for (int i = 0; i < 4; ++i) {
+        q.pop();
+    }
+    segments = q.segments();
+    ASSERT_EQ(segments.size(), 2);
+    EXPECT_EQ(*segments[0].first, 4);
+    
+    // Разметка существующей очереди и копирование
+    Queue<int> copy = q;
+    copy.enable_segments(3);
+    EXPECT_EQ(copy.segments().size(), 2);
+    copy.enable_segments(0);
+    EXPECT_EQ(copy.segments().size(), 1);
+}
+
+TEST(QueueParallelTest, ForEachReduceFind) {
+    ThreadPool pool(4);
+    Queue<Employee> q;
+    q.enable_segments(16);
+    for (int i = 0; i < 1000; ++i) {
+        q.push(Employee("E" + std::to_string(i), i, 10.0, "Dept"));
+    }
+    
+    parallel_for_each(q, pool, [](Employee& e) { e.salary *= 2; });
+    double total = parallel_transform_reduce(q, pool, 0.0, std::plus<>(), 
+                                             [](const Employee& e) { return e.salary; });
+    EXPECT_EQ(total, 20000.0);
+    
+    auto found = parallel_find_if(q, pool, [](const Employee& e) { return e.id >= 500; });
+    ASSERT_NE(found, q.end());
+    EXPECT_EQ(found->id, 500);
+    
+    auto missing = parallel_find_if(q, pool, [](const Employee& e) { return e.id < 0; });
+    EXPECT_EQ(missing, q.end());
+    
+    Queue<int> ints;
+    for (int i = 1; i <= 100; ++i) {
+        ints.push(i);
+    }
+    // Без разметки очередь обрабатывается одной задачей
+    EXPECT_EQ(parallel_reduce(ints, pool, 0), 5050);
+    EXPECT_EQ(*parallel_find(ints, pool, 42), 42);
+}
+
+// ==================== ТЕСТЫ ПРОИЗВОЛЬНОГО ДОСТУПА ====================
+
+static_assert(std::random_access_iterator<QueueIndexIterator<int>>);
+static_assert(std::ranges::random_access_range<QueueIndexView<int>>);
+static_assert(std::ranges::sized_range<QueueIndexView<int>>);
+
+TEST(QueueIndexTest, SubscriptWithAndWithoutIndex) {
+    Queue<int> q;
+    for (int i = 0; i < 10; ++i) {
+        q.push(i * 10);
+    }
+    
+    // Без индекса доступ линейный, но результат тот же
+    EXPECT_EQ(q[3], 30);
+    EXPECT_THROW(q.indexed_view(), std::runtime_error);
+    
+    q.enable_index();
+    EXPECT_TRUE(q.is_indexed());
+    EXPECT_EQ(q[3], 30);
+    EXPECT_EQ(q.at(9), 90);
+    EXPECT_THROW(q.at(10), std::out_of_range);
+    
+    // Индекс следует за push и pop
+    q.pop();
+    q.push(100);
+    EXPECT_EQ(q[0], 10);
+    EXPECT_EQ(q[9], 100);
+    EXPECT_EQ(q.indexed_view().size(), q.size());
+}
+
+TEST(QueueIndexTest, RandomAccessAlgorithms) {
+    Queue<int> q;
+    q.enable_index();
+    for (int value : {7, 3, 9, 1, 5, 8, 2}) {
+        q.push(value);
+    }
+    
+    auto view = q.indexed_view();
+    std::nth_element(view.begin(), view.begin() + 3, view.end());
+    EXPECT_EQ(view[3], 5);
+    
+    std::ranges::sort(view);
+    EXPECT_TRUE(std::binary_search(view.begin(), view.end(), 8));
+    EXPECT_EQ(view.end() - view.begin(), 7);
+    
+    // Сортировка переставляет данные внутри узлов, порядок обхода очереди тоже меняется
+    std::vector<int> collected(q.begin(), q.end());
+    EXPECT_TRUE(std::is_sorted(collected.begin(), collected.end()));
+    
+    // Копия и перемещение сохраняют индекс
+    Queue<int> copy = q;
+    EXPECT_EQ(copy.indexed_view()[6], 9);
+    Queue<int> moved = std::move(copy);
+    EXPECT_EQ(moved.indexed_view()[0], 1);
+}
+
+// ==================== ТЕСТЫ ПЕРСИСТЕНТНОЙ ОЧЕРЕДИ ====================
+
+struct Trade {
+    int id;
+    double price;
+};
+
+TEST(PersistentQueueTest, ReopenAfterClose) {
+    std::string path = (std::filesystem::temp_directory_path() / "oop_lab5_persistent.q").string();
+    std::filesystem::remove(path);
+    
+    {
+        MappedFileMemoryResource mr(path, 1 << 20);
+        EXPECT_TRUE(mr.created());
+        PersistentQueue<Trade> q(mr);
+        for (int i = 0; i < 100; ++i) {
+            q.push(Trade{i, i * 1.5});
+        }
+        q.pop();
+        q.sync();
+    }
+    
+    {
+        // Повторное открытие: данные на месте, освобождённый узел переиспользуется
+        MappedFileMemoryResource mr(path, 0);
+        EXPECT_FALSE(mr.created());
+        PersistentQueue<Trade> q(mr);
+        ASSERT_EQ(q.size(), 99);
+        EXPECT_EQ(q.front().id, 1);
+        EXPECT_EQ(q.back().price, 99 * 1.5);
+        
+        size_t used = mr.used();
+        q.push(Trade{100, 0.0});
+        EXPECT_EQ(mr.used(), used);
+        
+        int expected = 1;
+        for (auto& trade : q) {
+            EXPECT_EQ(trade.id, expected++);
+        }
+        
+        // Файл с очередью другого типа не принимается
+        EXPECT_THROW(PersistentQueue<long double> other(mr), std::runtime_error);
+    }
+    
+    std::filesystem::remove(path);
+}
+
+TEST(PersistentQueueTest, CapacityAndUnknownBlocks) {
+    std::string path = (std::filesystem::temp_directory_path() / "oop_lab5_small.q").string();
+    std::filesystem::remove(path);
+    {
+        MappedFileMemoryResource mr(path, 4096);
+        PersistentQueue<Trade> q(mr, 1);
+        EXPECT_THROW({
+            for (int i = 0; i < 1000; ++i) {
+                q.push(Trade{i, 0.0});
+            }
+        }, std::bad_alloc);
+        EXPECT_GT(q.size(), 0);
+        
+        int outside = 0;
+        EXPECT_THROW(mr.deallocate(&outside, sizeof(int), alignof(int)), std::invalid_argument);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(PersistentQueueTest, RepairsRootAfterInterruptedOperationsAndRejectsDoubleFree) {
+    std::string path = (std::filesystem::temp_directory_path() / "oop_lab5_crash.q").string();
+    std::filesystem::remove(path);
+    // Раскладка корня PersistentQueue: magic, node_size, head, tail, size
+    struct RootView {
+        uint64_t magic;
+        uint64_t node_size;
+        uint64_t head;
+        uint64_t tail;
+        uint64_t size;
+    };
+    {
+        MappedFileMemoryResource mr(path, 1 << 16);
+        PersistentQueue<Trade> q(mr);
+        q.push(Trade{1, 1.0});
+        // Сбой в pop последнего узла: tail уже обнулён, head ещё нет
+        static_cast<RootView*>(mr.root())->tail = 0;
+    }
+    {
+        MappedFileMemoryResource mr(path, 0);
+        PersistentQueue<Trade> q(mr);
+        // Прерванный pop не состоялся: элемент на месте
+        ASSERT_EQ(q.size(), 1);
+        EXPECT_EQ(q.back().id, 1);
+        q.pop();
+        EXPECT_TRUE(q.empty());
+        q.push(Trade{2, 2.0});
+        q.push(Trade{3, 3.0});
+        // Сбой в push после прицепления узла, но до записи tail и size
+        auto* root = static_cast<RootView*>(mr.root());
+        root->tail = root->head;
+        --root->size;
+    }
+    {
+        MappedFileMemoryResource mr(path, 0);
+        PersistentQueue<Trade> q(mr);
+        ASSERT_EQ(q.size(), 2);
+        EXPECT_EQ(q.back().id, 3);
+
+        void* a = mr.allocate(32, 8);
+        void* b = mr.allocate(32, 8);
+        mr.deallocate(a, 32, 8);
+        EXPECT_THROW(mr.deallocate(a, 32, 8), std::invalid_argument);
+        mr.deallocate(b, 32, 8);
+        EXPECT_THROW(mr.deallocate(b, 32, 8), std::invalid_argument);
+        EXPECT_THROW(mr.deallocate(a, 32, 8), std::invalid_argument);
+    }
+    {
+        // Файл прежней версии формата (без пометки выданных блоков) не принимается
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t old_version = 1;
+        file.seekp(sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&old_version), sizeof(old_version));
+    }
+    EXPECT_THROW(MappedFileMemoryResource(path, 0), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(PersistentQueueTest, ReopenDoesNotTouchEveryNode) {
+    std::string path = (std::filesystem::temp_directory_path() / "oop_lab5_large.q").string();
+    std::filesystem::remove(path);
+    const int count = 500000;
+    {
+        MappedFileMemoryResource mr(path, size_t(64) << 20);
+        PersistentQueue<Trade> q(mr);
+        for (int i = 0; i < count; ++i) {
+            q.push(Trade{i, i * 1.0});
+        }
+    }
+    // Свежее отображение: каждая тронутая страница файла - минимум одна
+    // страничная ошибка, проход по всем узлам дал бы их сотни
+    rusage before{};
+    rusage after{};
+    getrusage(RUSAGE_SELF, &before);
+    {
+        MappedFileMemoryResource mr(path, 0);
+        PersistentQueue<Trade> q(mr);
+        getrusage(RUSAGE_SELF, &after);
+        EXPECT_EQ(q.size(), static_cast<size_t>(count));
+        EXPECT_EQ(q.back().id, count - 1);
+    }
+    EXPECT_LT(after.ru_minflt - before.ru_minflt, 64);
+    std::filesystem::remove(path);
+}
+
+// ==================== ТЕСТЫ ОЧЕРЕДИ С ЖУРНАЛОМ ====================
+
+TEST(WalQueueTest, RecoversPushesAndConsumerOffset) {
+    auto dir = std::filesystem::temp_directory_path() / "oop_lab5_wal";
+    std::filesystem::remove_all(dir);
+    
+    {
+        WalQueue<Trade> q(dir, 8);
+        for (int i = 0; i < 20; ++i) {
+            q.push(Trade{i, i * 2.0});
+        }
+        q.pop();
+        q.pop();
+        // Деструктор фиксирует незавершённую группу
+    }
+    
+    {
+        WalQueue<Trade> q(dir, 8);
+        ASSERT_EQ(q.size(), 18);
+        EXPECT_EQ(q.front().id, 2);
+        EXPECT_EQ(q.back().id, 19);
+        q.pop();
+        q.push(Trade{20, 40.0});
+        q.commit();
+    }
+    
+    {
+        WalQueue<Trade> q(dir);
+        ASSERT_EQ(q.size(), 18);
+        EXPECT_EQ(q.front().id, 3);
+        EXPECT_EQ(q.back().id, 20);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WalQueueTest, SegmentsRotateAndTornTailIsIgnored) {
+    auto dir = std::filesystem::temp_directory_path() / "oop_lab5_wal_segments";
+    std::filesystem::remove_all(dir);
+    
+    {
+        // Сегмент вмещает 4 записи по 8 + 16 байт
+        WalQueue<Trade> q(dir, 1, 4 * 24);
+        for (int i = 0; i < 10; ++i) {
+            q.push(Trade{i, 0.0});
+        }
+        EXPECT_EQ(q.segment_count(), 3);
+        
+        // Полностью прочитанные сегменты удаляются при фиксации
+        for (int i = 0; i < 8; ++i) {
+            q.pop();
+        }
+        q.commit();
+        EXPECT_EQ(q.segment_count(), 1);
+    }
+    
+    // Имитация оборванной при сбое записи в конце последнего сегмента
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() == ".wal") {
+            std::FILE* f = std::fopen(entry.path().c_str(), "ab");
+            std::fputs("torn", f);
+            std::fclose(f);
+        }
+    }
+    
+    {
+        WalQueue<Trade> q(dir, 1, 4 * 24);
+        ASSERT_EQ(q.size(), 2);
+        EXPECT_EQ(q.front().id, 8);
+        q.push(Trade{10, 0.0});
+    }
+    {
+        WalQueue<Trade> q(dir, 1, 4 * 24);
+        ASSERT_EQ(q.size(), 3);
+        EXPECT_EQ(q.back().id, 10);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// ==================== ТЕСТЫ СЕРИАЛИЗАЦИИ ====================
+
+// Пользовательский сериализатор: строки с префиксом длины, числа как есть
+template<>
+struct QueueSerializer<Employee> {
+    static size_t size(const Employee& e) {
+        return 2 * sizeof(uint32_t) + e.name.size() + e.department.size() + sizeof(e.id) + sizeof(e.salary);
+    }
+    
+    static void write(const Employee& e, std::byte* out) {
+        for (const std::string* s : {&e.name, &e.department}) {
+            uint32_t length = static_cast<uint32_t>(s->size());
+            std::memcpy(out, &length, sizeof(length));
+            std::memcpy(out + sizeof(length), s->data(), length);
+            out += sizeof(length) + length;
+        }
+        std::memcpy(out, &e.id, sizeof(e.id));
+        std::memcpy(out + sizeof(e.id), &e.salary, sizeof(e.salary));
+    }
+    
+    static Employee read(const std::byte* in, size_t) {
+        Employee e;
+        for (std::string* s : {&e.name, &e.department}) {
+            uint32_t length;
+            std::memcpy(&length, in, sizeof(length));
+            s->assign(reinterpret_cast<const char*>(in + sizeof(length)), length);
+            in += sizeof(length) + length;
+        }
+        std::memcpy(&e.id, in, sizeof(e.id));
+        std::memcpy(&e.salary, in + sizeof(e.id), sizeof(e.salary));
+        return e;
+    }
+};
+
+TEST(QueueSerializationTest, TriviallyCopyableRoundTrip) {
+    Queue<Trade> q;
+    for (int i = 0; i < 50; ++i) {
+        q.push(Trade{i, i * 0.5});
+    }
+    
+    auto blob = serialize_queue(q);
+    EXPECT_EQ(blob.size(), sizeof(QueueBlobHeader) + 50 * sizeof(Trade));
+    
+    // Узлы выделяются из одного буфера monotonic-ресурса
+    std::vector<std::byte> buffer(deserialized_node_bytes<Trade>(blob));
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), 
+                                              std::pmr::null_memory_resource());
+    Queue<Trade> restored = deserialize_queue<Trade>(blob, &arena);
+    ASSERT_EQ(restored.size(), 50);
+    EXPECT_EQ(restored.back().price, 24.5);
+    
+    // Обход константной очереди
+    const Queue<Trade>& view = restored;
+    int expected = 0;
+    for (const Trade& t : view) {
+        EXPECT_EQ(t.id, expected++);
+    }
+}
+
+TEST(QueueSerializationTest, CustomSerializersAndFiles) {
+    Queue<std::string> strings;
+    strings.push("alpha");
+    strings.push("");
+    strings.push("gamma");
+    auto restored = deserialize_queue<std::string>(serialize_queue(strings));
+    EXPECT_TRUE(std::equal(restored.begin(), restored.end(), strings.begin()));
+    
+    Queue<Employee> staff;
+    staff.push(Employee("Alice", 1, 100.5, "IT"));
+    staff.push(Employee("Bob", 2, 200.0, "HR"));
+    auto path = std::filesystem::temp_directory_path() / "oop_lab5_staff.qblob";
+    write_queue_file(staff, path);
+    Queue<Employee> loaded = read_queue_file<Employee>(path);
+    ASSERT_EQ(loaded.size(), 2);
+    EXPECT_EQ(loaded.front(), staff.front());
+    EXPECT_EQ(loaded.back(), staff.back());
+    std::filesystem::remove(path);
+    
+    // Повреждённые и чужие данные отвергаются
+    auto blob = serialize_queue(staff);
+    EXPECT_THROW(deserialize_queue<Trade>(blob), std::runtime_error);
+    blob.resize(blob.size() - 1);
+    EXPECT_THROW(deserialize_queue<Employee>(blob), std::runtime_error);
+    blob[0] = std::byte{'X'};
+    EXPECT_THROW(deserialize_queue<Employee>(blob), std::runtime_error);
+}
+
+// Сериализатор, заявляющий запись больше 4 ГиБ, без реальных данных
+struct OversizedRecord {};
+
+template<>
+struct QueueSerializer<OversizedRecord> {
+    static size_t size(const OversizedRecord&) {
+        return size_t(1) << 32;
+    }
+
+    static void write(const OversizedRecord&, std::byte*) {}
+
+    static OversizedRecord read(const std::byte*, size_t) {
+        return {};
+    }
+};
+
+TEST(QueueSerializationTest, RejectsOversizedRecordsAndHugeCounts) {
+    Queue<OversizedRecord> huge;
+    huge.push(OversizedRecord{});
+    EXPECT_THROW(serialize_queue(huge), std::length_error);
+
+    Queue<int> ints;
+    ints.push(1);
+    ints.push(2);
+    auto blob = serialize_queue(ints);
+    QueueBlobHeader header;
+    std::memcpy(&header, blob.data(), sizeof(header));
+    // count * sizeof(int) переполняется и совпал бы с payload_bytes
+    header.count = (uint64_t(1) << 62) + 2;
+    std::memcpy(blob.data(), &header, sizeof(header));
+    EXPECT_THROW(deserialize_queue<int>(blob), std::runtime_error);
+    EXPECT_THROW(deserialized_node_bytes<int>(blob), std::runtime_error);
+}
+
+// ==================== ТЕСТЫ АСИНХРОННОЙ ОЧЕРЕДИ ====================
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+AsyncTask collect(std::allocator_arg_t, std::pmr::memory_resource*, 
+                  AsyncQueue<int>& q, std::vector<int>& out, int count) {
+    for (int i = 0; i < count; ++i) {
+        out.push_back(co_await q.pop_async());
+    }
+}
+
+TEST(AsyncQueueTest, PushResumesWaitersInOrder) {
+    CountingResource frames;
+    AsyncQueue<int> q;
+    std::vector<int> first, second;
+    
+    {
+        AsyncTask a = collect(std::allocator_arg, &frames, q, first, 2);
+        AsyncTask b = collect(std::allocator_arg, &frames, q, second, 1);
+        EXPECT_EQ(frames.allocations, 2);
+        EXPECT_TRUE(q.has_waiters());
+        
+        // Каждый push будит ровно одного ожидающего
+        q.push(1);
+        EXPECT_EQ(first, std::vector<int>({1}));
+        EXPECT_TRUE(second.empty());
+        q.push(2);
+        EXPECT_EQ(second, std::vector<int>({2}));
+        EXPECT_TRUE(b.done());
+        q.push(3);
+        EXPECT_TRUE(a.done());
+        EXPECT_EQ(first, std::vector<int>({1, 3}));
+        
+        // Непустая очередь отдаёт элемент без приостановки
+        q.push(4);
+        std::vector<int> third;
+        AsyncTask c = collect(std::allocator_arg, &frames, q, third, 1);
+        EXPECT_TRUE(c.done());
+        EXPECT_EQ(third, std::vector<int>({4}));
+    }
+    EXPECT_EQ(frames.deallocations, 3);
+}
+
+TEST(AsyncQueueTest, ExecutorAndBlockMemoryResourceFrames) {
+    BlockMemoryResource mr;
+    Queue<std::coroutine_handle<>> ready(&mr);
+    AsyncQueue<std::string> q(&mr, [&ready](std::coroutine_handle<> h) { ready.push(std::move(h)); });
+    
+    std::vector<std::string> received;
+    // Кадр корутины-лямбды тоже берётся из BlockMemoryResource
+    auto consumer = [&](std::allocator_arg_t, std::pmr::memory_resource*) -> AsyncTask {
+        received.push_back(co_await q.pop_async());
+    };
+    AsyncTask task = consumer(std::allocator_arg, &mr);
+    
+    // Через executor корутина возобновляется не внутри push
+    q.push("hello");
+    EXPECT_TRUE(received.empty());
+    ready.front().resume();
+    ready.pop();
+    EXPECT_EQ(received, std::vector<std::string>({"hello"}));
+    EXPECT_NO_THROW(task.get());
+}
+
+TEST(AsyncQueueTest, DestroyedWaiterLeavesTheList) {
+    CountingResource frames;
+    AsyncQueue<int> q;
+    std::vector<int> first, second, third;
+    {
+        AsyncTask a = collect(std::allocator_arg, &frames, q, first, 1);
+        AsyncTask b = collect(std::allocator_arg, &frames, q, second, 1);
+        AsyncTask c = collect(std::allocator_arg, &frames, q, third, 1);
+        {
+            // Средний ожидающий уничтожается, не дождавшись элемента
+            AsyncTask doomed = std::move(b);
+        }
+        EXPECT_TRUE(q.has_waiters());
+        q.push(1);
+        q.push(2);
+        EXPECT_FALSE(q.has_waiters());
+        EXPECT_EQ(first, std::vector<int>({1}));
+        EXPECT_EQ(third, std::vector<int>({2}));
+        EXPECT_TRUE(second.empty());
+
+        AsyncTask d = collect(std::allocator_arg, &frames, q, second, 1);
+        {
+            AsyncTask doomed = std::move(d);
+        }
+        EXPECT_FALSE(q.has_waiters());
+        q.push(3);
+        EXPECT_EQ(q.size(), 1u);
+    }
+    EXPECT_EQ(frames.allocations, frames.deallocations);
+}
+
+// ==================== ТЕСТЫ ОЧЕРЕДИ С РАССЫЛКОЙ ====================
+
+TEST(BroadcastQueueTest, NodesSharedUntilSlowestSubscriber) {
+    CountingResource mr;
+    BroadcastQueue<std::string> q(&mr);
+    auto fast = q.subscribe();
+    auto slow = q.subscribe();
+    
+    q.push("a");
+    q.push("b");
+    EXPECT_EQ(q.retained(), 2);
+    EXPECT_EQ(q.front(fast), "a");
+    EXPECT_EQ(q.front(slow), "a");
+    
+    // Быстрый подписчик прочитал всё, узлы ещё нужны медленному
+    q.pop(fast);
+    q.pop(fast);
+    EXPECT_EQ(q.try_front(fast), nullptr);
+    EXPECT_THROW(q.pop(fast), std::runtime_error);
+    EXPECT_EQ(q.retained(), 2);
+    EXPECT_EQ(q.lag(slow), 2);
+    
+    q.pop(slow);
+    EXPECT_EQ(q.retained(), 1);
+    EXPECT_EQ(q.front(slow), "b");
+    q.unsubscribe(slow);
+    EXPECT_EQ(q.retained(), 0);
+    EXPECT_THROW(q.front(slow), std::invalid_argument);
+    
+    // Узлы вернулись в ресурс (остался только страж)
+    EXPECT_EQ(mr.allocations - mr.deallocations, 1);
+}
+
+TEST(BroadcastQueueTest, LagLimitPolicies) {
+    BroadcastQueue<int> strict(std::pmr::get_default_resource(), 2);
+    auto reader = strict.subscribe();
+    strict.push(1);
+    strict.push(2);
+    EXPECT_THROW(strict.push(3), std::runtime_error);
+    strict.pop(reader);
+    EXPECT_NO_THROW(strict.push(3));
+    
+    BroadcastQueue<int> lossy(std::pmr::get_default_resource(), 2, 
+                              BroadcastQueue<int>::LagPolicy::Disconnect);
+    auto active = lossy.subscribe();
+    auto idle = lossy.subscribe();
+    for (int i = 0; i < 3; ++i) {
+        lossy.push(i);
+        lossy.pop(active);
+    }
+    // Отставший подписчик отключён, его узлы освобождены
+    EXPECT_FALSE(lossy.is_subscribed(idle));
+    EXPECT_TRUE(lossy.is_subscribed(active));
+    EXPECT_EQ(lossy.subscriber_count(), 1);
+    EXPECT_EQ(lossy.retained(), 0);
+}
+
+// ==================== ТЕСТЫ ПАКЕТНОГО ПОТРЕБЛЕНИЯ ====================
+
+TEST(QueueTryOperationsTest, TryFrontAndTryPop) {
+    Queue<std::string> q;
+    EXPECT_EQ(q.try_front(), nullptr);
+    EXPECT_FALSE(q.try_pop().has_value());
+    
+    q.push("first");
+    q.push("second");
+    ASSERT_NE(q.try_front(), nullptr);
+    EXPECT_EQ(*q.try_front(), "first");
+    
+    auto value = q.try_pop();
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(*value, "first");
+    EXPECT_EQ(q.size(), 1);
+    EXPECT_EQ(q.front(), "second");
+}
+
+TEST(QueueTryOperationsTest, PopValueAndTryBack) {
+    Queue<std::unique_ptr<int>> q;
+    EXPECT_EQ(q.try_back(), nullptr);
+    EXPECT_THROW(q.pop_value(), std::runtime_error);
+    
+    q.push(std::make_unique<int>(1));
+    q.push(std::make_unique<int>(2));
+    EXPECT_EQ(**q.try_back(), 2);
+    
+    // Элемент перемещается наружу, узел освобождается сразу
+    std::unique_ptr<int> first = q.pop_value();
+    EXPECT_EQ(*first, 1);
+    EXPECT_EQ(q.size(), 1);
+    
+    // Опрос в цикле без исключений
+    int polled = 0;
+    while (auto item = q.try_pop()) {
+        polled += **item;
+    }
+    EXPECT_EQ(polled, 2);
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.try_back(), nullptr);
+}
+
+TEST(BlockingQueueTest, BatchSizeAdaptsToDepth) {
+    BlockingQueue<int> q;
+    for (int i = 0; i < 100; ++i) {
+        q.push(i);
+    }
+    
+    // Пока очередь длинная, пакеты растут: 1, 2, 4, 8 ...
+    std::vector<size_t> sizes;
+    std::vector<int> seen;
+    while (!q.empty()) {
+        sizes.push_back(q.consume(16, std::chrono::milliseconds(0), [&](std::span<int> batch) {
+            seen.insert(seen.end(), batch.begin(), batch.end());
+        }));
+    }
+    ASSERT_GE(sizes.size(), 5);
+    EXPECT_EQ(sizes[0], 1);
+    EXPECT_EQ(sizes[1], 2);
+    EXPECT_EQ(sizes[4], 16);
+    ASSERT_EQ(seen.size(), 100);
+    EXPECT_TRUE(std::is_sorted(seen.begin(), seen.end()));
+    
+    // При слабом потоке предел снова уменьшается
+    q.push(1);
+    q.consume(16, std::chrono::milliseconds(0), [](std::span<int>) {});
+    EXPECT_LT(q.current_batch_limit(), 16);
+    
+    // Пустая очередь: выход по таймауту
+    EXPECT_EQ(q.consume(16, std::chrono::milliseconds(1), [](std::span<int>) {}), 0);
+}
+
+TEST(BlockingQueueTest, ConsumerWakesOnPushAndClose) {
+    BlockingQueue<int> q;
+    std::atomic<int> total(0);
+    std::thread consumer([&] {
+        while (q.consume(8, std::chrono::seconds(5), [&](std::span<int> batch) {
+            for (int v : batch) {
+                total += v;
+            }
+        }) || !q.is_closed()) {
+        }
+    });
+    
+    for (int i = 1; i <= 10; ++i) {
+        q.push(i);
+    }
+    q.close();
+    consumer.join();
+    EXPECT_EQ(total, 55);
+    EXPECT_THROW(q.push(1), std::runtime_error);
+}
+
+// ==================== ТЕСТЫ КЭША УЗЛОВ ====================
+
+TEST(QueueNodeCacheTest, PopPushReusesCachedNodes) {
+    CountingResource mr;
+    Queue<int> q(&mr);
+    q.set_node_cache_limit(4);
+    
+    for (int i = 0; i < 10; ++i) {
+        q.push(i);
+    }
+    EXPECT_EQ(mr.allocations, 10);
+    
+    // Первые 4 освобождённых узла остаются в кэше, остальные уходят в ресурс
+    q.clear();
+    EXPECT_EQ(q.cached_node_count(), 4);
+    EXPECT_EQ(mr.deallocations, 6);
+    
+    // Повторные push берут узлы из кэша, не обращаясь к ресурсу
+    for (int i = 0; i < 4; ++i) {
+        q.push(i);
+    }
+    EXPECT_EQ(mr.allocations, 10);
+    EXPECT_EQ(q.cached_node_count(), 0);
+    
+    q.clear();
+    q.shrink();
+    EXPECT_EQ(q.cached_node_count(), 0);
+    EXPECT_EQ(mr.deallocations, 10);
+}
+
+TEST(QueueNodeCacheTest, LimitAndDestructorReturnNodes) {
+    CountingResource mr;
+    {
+        Queue<std::string> q(&mr);
+        EXPECT_EQ(q.node_cache_limit(), queue_default_node_cache_limit);
+        for (int i = 0; i < 8; ++i) {
+            q.push(std::to_string(i));
+        }
+        q.clear();
+        EXPECT_EQ(q.cached_node_count(), 8);
+        
+        q.set_node_cache_limit(2);
+        EXPECT_EQ(q.cached_node_count(), 2);
+        
+        // Перемещённая очередь забирает кэш с собой
+        Queue<std::string> moved = std::move(q);
+        EXPECT_EQ(moved.cached_node_count(), 2);
+        EXPECT_EQ(q.cached_node_count(), 0);
+    }
+    EXPECT_EQ(mr.allocations, mr.deallocations);
+}
+
+// ==================== ТЕСТЫ СТАТИЧЕСКИХ РАСПРЕДЕЛИТЕЛЕЙ ====================
+
+TEST(QueueStaticAllocatorTest, BlockAllocatorAndStdAllocator) {
+    BlockPool pool;
+    Queue<std::string, BlockAllocator<std::string>> q{BlockAllocator<std::string>(pool)};
+    for (int i = 0; i < 100; ++i) {
+        q.push(std::to_string(i));
+    }
+    EXPECT_EQ(q.front(), "0");
+    EXPECT_EQ(q.back(), "99");
+    EXPECT_EQ(q.get_allocator().get_pool(), &pool);
+    
+    // Узлы одного размерного класса переиспользуются пулом
+    q.set_node_cache_limit(0);
+    void* freed = &q.front();
+    q.pop();
+    q.push("reused");
+    EXPECT_EQ(&q.back(), freed);
+    
+    Queue<int, std::allocator<int>> plain;
+    plain.push(1);
+    plain.push(2);
+    EXPECT_EQ(plain.pop_value(), 1);
+    Queue<int, std::allocator<int>> plain_copy = plain;
+    EXPECT_EQ(plain_copy.front(), 2);
+}
+
+TEST(QueueStaticAllocatorTest, AssignmentFollowsPropagationTraits) {
+    // BlockAllocator распространяется при присваивании
+    BlockPool pool_a, pool_b;
+    using BlockQueue = Queue<int, BlockAllocator<int>>;
+    BlockQueue a{BlockAllocator<int>(pool_a)};
+    BlockQueue b{BlockAllocator<int>(pool_b)};
+    a.push(1);
+    b.push(2);
+    b = a;
+    EXPECT_EQ(b.get_allocator().get_pool(), &pool_a);
+    EXPECT_EQ(b.front(), 1);
+    
+    BlockQueue c{BlockAllocator<int>(pool_b)};
+    c = std::move(a);
+    EXPECT_EQ(c.get_allocator().get_pool(), &pool_a);
+    EXPECT_TRUE(a.empty());
+    
+    // polymorphic_allocator не распространяется: элементы переносятся в свой ресурс
+    BlockMemoryResource mr1, mr2;
+    Queue<std::string> p1(&mr1), p2(&mr2);
+    p1.push("x");
+    p1.push("y");
+    p2 = std::move(p1);
+    EXPECT_EQ(p2.get_allocator().resource(), &mr2);
+    EXPECT_EQ(p2.size(), 2);
+    EXPECT_EQ(p2.front(), "x");
+    EXPECT_TRUE(p1.empty());
+    
+    p1 = p2;
+    EXPECT_EQ(p1.get_allocator().resource(), &mr1);
+    EXPECT_EQ(p1.back(), "y");
+    
+    swap(p1, p2);
+    EXPECT_EQ(p1.get_allocator().resource(), &mr1);
+    EXPECT_EQ(p1.size(), 2);
+}
+
+// ==================== ТЕСТЫ ТРАССИРОВКИ ВЫДЕЛЕНИЙ ====================
+
+#if BLOCK_MEMORY_RESOURCE_TRACING
+TEST(BlockMemoryResourceTracingTest, DetectsDoubleFreeAndMismatch) {
+    BlockMemoryResource mr;
+    mr.enable_tracing(true, nullptr);
+    
+    void* p = mr.allocate(64, 16);
+    EXPECT_THROW(mr.deallocate(p, 32, 16), std::invalid_argument);
+    EXPECT_THROW(mr.deallocate(p, 64, 8), std::invalid_argument);
+    EXPECT_NO_THROW(mr.deallocate(p, 64, 16));
+    
+    // Повторное освобождение распознаётся как double free
+    try {
+        mr.deallocate(p, 64, 16);
+        FAIL() << "double free not detected";
+    } catch (const std::invalid_argument& e) {
+        EXPECT_STREQ(e.what(), "Double free of block");
+    }
+}
+
+TEST(BlockMemoryResourceTracingTest, LeakReportAtDestruction) {
+    std::ostringstream report;
+    {
+        BlockMemoryResource mr;
+        mr.enable_tracing(true, &report);
+        
+        mr.set_allocation_tag("orders");
+        Queue<int> q(&mr);
+        q.push(1);
+        q.push(2);
+        q.pop();
+        
+        mr.set_allocation_tag("leaked");
+        void* leaked = mr.allocate(100, 8);
+        EXPECT_NE(leaked, nullptr);
+        // Извлечённый узел остаётся в кэше очереди, поэтому живых блоков три
+        EXPECT_EQ(mr.live_allocation_count(), 3);
+        // Очередь уничтожается раньше ресурса, поэтому в отчёте останется один блок
+    }
+    std::string text = report.str();
+    EXPECT_NE(text.find("1 block(s), 100 byte(s)"), std::string::npos);
+    EXPECT_NE(text.find("tag=leaked"), std::string::npos);
+    EXPECT_EQ(text.find("tag=orders"), std::string::npos);
+}
+#endif
+
+// ==================== ТЕСТЫ ВЫШЕСТОЯЩЕГО РЕСУРСА ====================
+
+TEST(BlockMemoryResourceUpstreamTest, BlocksComeFromUpstream) {
+    CountingResource upstream;
+    {
+        BlockMemoryResource mr(&upstream);
+        EXPECT_EQ(mr.upstream_resource(), &upstream);
+        
+        void* p = mr.allocate(128, 64);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % 64, 0);
+        mr.deallocate(p, 128, 64);
+        
+        // Освобождённый блок переиспользуется без обращения к upstream...
+        EXPECT_EQ(mr.allocate(100, 32), p);
+        // ...но не для более строгого выравнивания
+        void* strict = mr.allocate(64, 128);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(strict) % 128, 0);
+        EXPECT_EQ(upstream.allocations, 2);
+        EXPECT_EQ(upstream.deallocations, 0);
+    }
+    // Все блоки возвращаются upstream при разрушении ресурса
+    EXPECT_EQ(upstream.deallocations, 2);
+}
+
+TEST(BlockMemoryResourceUpstreamTest, LayeredOverStackBuffer) {
+    std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    BlockMemoryResource mr(&arena);
+    
+    Queue<int> q(&mr);
+    for (int i = 0; i < 20; ++i) {
+        q.push(i);
+    }
+    EXPECT_EQ(q.back(), 19);
+    
+    // Узлы лежат в стековом буфере
+    auto* node_address = reinterpret_cast<std::byte*>(&q.front());
+    EXPECT_GE(node_address, buffer);
+    EXPECT_LT(node_address, buffer + sizeof(buffer));
+}
+
+// ==================== ТЕСТЫ HUGE PAGE РЕСУРСА ====================
+
+TEST(HugePageMemoryResourceTest, QueueOnHugePages) {
+    HugePageMemoryResource::Options options;
+    options.chunk_size = 1;
+    HugePageMemoryResource mr(options);
+    Queue<int> q(&mr);
+    for (int i = 0; i < 100000; ++i) {
+        q.push(i);
+    }
+    EXPECT_EQ(q.size(), 100000u);
+    EXPECT_EQ(q.front(), 0);
+    EXPECT_EQ(q.back(), 99999);
+
+    // Куски кратны huge page, их начало выровнено на 2 МБ
+    EXPECT_GE(mr.chunk_count(), 1u);
+    EXPECT_EQ(mr.mapped_bytes() % HugePageMemoryResource::huge_page_size, 0u);
+    // На однонодовой машине привязки нет, но ресурс работает
+    if (mr.numa_node() < 0) {
+        EXPECT_FALSE(mr.numa_bound());
+    }
+
+    void* big = mr.allocate(3 * HugePageMemoryResource::huge_page_size, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 64, 0u);
+    std::memset(big, 1, 3 * HugePageMemoryResource::huge_page_size);
+    mr.deallocate(big, 3 * HugePageMemoryResource::huge_page_size, 64);
+}
+
+TEST(HugePageMemoryResourceTest, UpstreamForBlockResource) {
+    HugePageMemoryResource huge;
+    {
+        BlockMemoryResource blocks(&huge);
+        Queue<std::string> q(&blocks);
+        for (int i = 0; i < 1000; ++i) {
+            q.push("value " + std::to_string(i));
+        }
+        while (q.size() > 10) {
+            q.pop();
+        }
+        EXPECT_EQ(q.front(), "value 990");
+        EXPECT_EQ(blocks.upstream_resource(), &huge);
+    }
+    EXPECT_EQ(huge.chunk_count(), 1u);
+
+    huge.release();
+    EXPECT_EQ(huge.chunk_count(), 0u);
+    EXPECT_EQ(huge.mapped_bytes(), 0u);
+    // После release ресурс снова выдаёт память
+    Queue<int> q(&huge);
+    q.push(7);
+    EXPECT_EQ(q.front(), 7);
+}
+
+// ==================== ТЕСТЫ SOA ОЧЕРЕДИ ====================
+
+TEST(SoaQueueTest, FifoAcrossChunks) {
+    CountingResource counting;
+    {
+        SoaQueue<std::string, int, double, std::string> q(&counting);
+        const size_t n = SoaQueue<std::string, int, double, std::string>::chunk_capacity * 3 + 5;
+        for (size_t i = 0; i < n; ++i) {
+            Employee e("Employee " + std::to_string(i), static_cast<int>(i), 1000.0 + i, "IT");
+            q.push(e.name, e.id, e.salary, e.department);
+        }
+        EXPECT_EQ(q.size(), n);
+        EXPECT_EQ(std::get<1>(q.back()), static_cast<int>(n - 1));
+
+        for (size_t i = 0; i < n / 2; ++i) {
+            auto [name, id, salary, department] = q.pop_value();
+            EXPECT_EQ(name, "Employee " + std::to_string(i));
+            EXPECT_EQ(id, static_cast<int>(i));
+            EXPECT_DOUBLE_EQ(salary, 1000.0 + i);
+        }
+        EXPECT_EQ(q.front<1>(), static_cast<int>(n / 2));
+        std::get<2>(q.front()) = -1.0;
+        EXPECT_DOUBLE_EQ(q.front<2>(), -1.0);
+
+        q.clear();
+        EXPECT_TRUE(q.empty());
+        EXPECT_THROW(q.pop(), std::runtime_error);
+        // Опустевший кусок переиспользуется без новых выделений
+        size_t before = counting.allocations;
+        q.push(std::string("x"), 1, 2.0, std::string("y"));
+        EXPECT_EQ(counting.allocations, before);
+    }
+    EXPECT_EQ(counting.allocations, counting.deallocations);
+}
+
+TEST(SoaQueueTest, ColumnScanMatchesRows) {
+    SoaQueue<int, double> q;
+    double expected = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+        q.push(i, i * 0.5);
+        expected += i * 0.5;
+    }
+    for (int i = 0; i < 700; ++i) {
+        expected -= std::get<1>(q.pop_value());
+    }
+
+    double sum = 0.0;
+    size_t chunks = 0;
+    q.for_each_chunk<1>([&](std::span<const double> column) {
+        // Колонка каждого куска начинается с кэш-линии
+        if (chunks++ > 0) {
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(column.data()) % queue_cache_line_size, 0u);
+        }
+        sum += std::accumulate(column.begin(), column.end(), 0.0);
+    });
+    EXPECT_DOUBLE_EQ(sum, expected);
+
+    int next = 700;
+    q.for_each([&](int id, double value) {
+        EXPECT_EQ(id, next);
+        EXPECT_DOUBLE_EQ(value, next * 0.5);
+        ++next;
+    });
+    EXPECT_EQ(next, 5000);
+
+    SoaQueue<int, double> copy(q);
+    SoaQueue<int, double> moved(std::move(q));
+    EXPECT_EQ(copy.size(), 4300u);
+    EXPECT_EQ(moved.front<0>(), 700);
+    EXPECT_TRUE(q.empty());
+}
+
+// ==================== ТЕСТЫ SIMD ЯДЕР ====================
+
+TEST(SimdKernelsTest, AllLevelsMatchScalar) {
+    std::vector<int32_t> ints(1003);
+    std::vector<double> doubles(1003);
+    for (size_t i = 0; i < ints.size(); ++i) {
+        ints[i] = static_cast<int32_t>((i * 7919) % 201) - 100;
+        doubles[i] = static_cast<double>(ints[i]) * 0.25;
+    }
+    ints[517] = 12345;
+    doubles[1001] = -999.5;
+
+    const SimdLevel detected = simd_level();
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2}) {
+        simd_set_level(level);
+        EXPECT_LE(simd_level(), detected);
+        // Отрезки разной длины проверяют хвосты, не кратные ширине вектора
+        for (size_t n : {0u, 1u, 3u, 7u, 8u, 9u, 1003u}) {
+            std::span<const int32_t> is(ints.data(), n);
+            std::span<const double> ds(doubles.data(), n);
+            EXPECT_EQ(simd_find(is, 12345), std::find(is.begin(), is.end(), 12345) - is.begin());
+            EXPECT_EQ(simd_find(ds, -999.5), std::find(ds.begin(), ds.end(), -999.5) - ds.begin());
+            EXPECT_EQ(simd_count(is, 0), static_cast<size_t>(std::count(is.begin(), is.end(), 0)));
+            EXPECT_EQ(simd_count(ds, 0.25), static_cast<size_t>(std::count(ds.begin(), ds.end(), 0.25)));
+            EXPECT_EQ(simd_sum(is), std::accumulate(is.begin(), is.end(), int64_t(0)));
+            EXPECT_DOUBLE_EQ(simd_sum(ds), std::accumulate(ds.begin(), ds.end(), 0.0));
+            if (n > 0) {
+                auto [ilo, ihi] = std::minmax_element(is.begin(), is.end());
+                EXPECT_EQ(simd_min_max(is), std::make_pair(*ilo, *ihi));
+                auto [dlo, dhi] = std::minmax_element(ds.begin(), ds.end());
+                EXPECT_EQ(simd_min_max(ds), std::make_pair(*dlo, *dhi));
+            }
+        }
+    }
+    simd_set_level(detected);
+    EXPECT_EQ(simd_level(), detected);
+}
+
+TEST(SimdKernelsTest, QueueAndSoaQueueChunks) {
+    Queue<int> q;
+    SoaQueue<double> soa;
+    for (int i = 0; i < 3000; ++i) {
+        q.push(i % 100);
+        soa.push(static_cast<double>(i));
+    }
+    for (int i = 0; i < 50; ++i) {
+        q.pop();
+        soa.pop();
+    }
+
+    // Позиции считаются от текущей головы, через границы кусков
+    EXPECT_EQ(queue_find(q, 49), 99u);
+    EXPECT_EQ(queue_find(q, 1000), q.size());
+    EXPECT_EQ(queue_count(q, 7), 29u);
+    EXPECT_EQ(queue_sum(q), std::accumulate(q.begin(), q.end(), int64_t(0)));
+    EXPECT_EQ(queue_min_max(q), std::make_pair(0, 99));
+
+    EXPECT_EQ(queue_find(soa, 2500.0), 2450u);
+    EXPECT_EQ(queue_count(soa, 10.0), 0u);
+    EXPECT_DOUBLE_EQ(queue_sum(soa), (50.0 + 2999.0) * 2950.0 / 2.0);
+    EXPECT_EQ(queue_min_max(soa), std::make_pair(50.0, 2999.0));
+
+    // Типы без векторных ядер идут через скалярный путь
+    Queue<short> shorts;
+    shorts.push(3);
+    shorts.push(-4);
+    EXPECT_EQ(queue_sum(shorts), -1);
+    EXPECT_EQ(queue_min_max(shorts), (std::pair<short, short>(-4, 3)));
+
+    Queue<int> empty;
+    EXPECT_EQ(queue_sum(empty), 0);
+    EXPECT_THROW(queue_min_max(empty), std::runtime_error);
+}
+
+// ==================== ТЕСТЫ СТАТИЧЕСКОЙ ОЧЕРЕДИ ====================
+
+// Таблица собирается при компиляции: кольцо ёмкости 5 (не степень двойки)
+// несколько раз проходит через границу буфера
+constexpr int static_queue_table_sum() {
+    StaticQueue<int, 5> q;
+    int sum = 0;
+    for (int i = 0; i < 20; ++i) {
+        q.push(i);
+        if (q.size() == 3) {
+            sum += q.pop_value();
+        }
+    }
+    for (int v : q) {
+        sum += v * 100;
+    }
+    return sum;
+}
+
+constexpr StaticQueue<int, 8> static_queue_squares() {
+    StaticQueue<int, 8> q;
+    for (int i = 1; i <= 8; ++i) {
+        q.push(i * i);
+    }
+    q.pop();
+    q.push(81);
+    return q;
+}
+
+TEST(StaticQueueTest, ConstexprEvaluation) {
+    static_assert(static_queue_table_sum() == 153 + 1800 + 1900);
+    constexpr StaticQueue<int, 8> squares = static_queue_squares();
+    static_assert(squares.size() == 8);
+    static_assert(squares.full());
+    static_assert(squares.front() == 4);
+    static_assert(squares.back() == 81);
+    static_assert(squares[7] == 81);
+    static_assert(StaticQueue<int, 8>::capacity() == 8);
+
+    std::vector<int> values(squares.begin(), squares.end());
+    EXPECT_EQ(values, (std::vector<int>{4, 9, 16, 25, 36, 49, 64, 81}));
+}
+
+TEST(StaticQueueTest, RuntimeOperations) {
+    StaticQueue<std::string, 3> q;
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.try_front(), nullptr);
+    EXPECT_FALSE(q.try_pop().has_value());
+    EXPECT_THROW(q.front(), std::runtime_error);
+
+    q.push("a");
+    q.push(std::string("b"));
+    EXPECT_TRUE(q.try_push("c"));
+    EXPECT_FALSE(q.try_push("d"));
+    EXPECT_THROW(q.push("d"), std::length_error);
+
+    EXPECT_EQ(q.pop_value(), "a");
+    q.push("d");
+    EXPECT_EQ(*q.try_back(), "d");
+
+    StaticQueue<std::string, 3> copy(q);
+    StaticQueue<std::string, 3> moved(std::move(q));
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(std::vector<std::string>(copy.begin(), copy.end()), (std::vector<std::string>{"b", "c", "d"}));
+    EXPECT_EQ(moved.try_pop(), std::optional<std::string>("b"));
+
+    // Тип без конструктора по умолчанию хранится в ячейке-объединении
+    struct NoDefault {
+        int v;
+        explicit NoDefault(int x) : v(x) {}
+    };
+    StaticQueue<NoDefault, 2> nd;
+    nd.push(NoDefault(5));
+    EXPECT_EQ(nd.front().v, 5);
+    for (auto it = nd.cbegin(); it != nd.cend(); ++it) {
+        EXPECT_EQ(it->v, 5);
+    }
+}
+
+// ==================== ТЕСТЫ УДАЛЕНИЯ ИЗ СЕРЕДИНЫ ====================
+
+TEST(QueueEraseTest, EraseIfRelinksInPlace) {
+    CountingResource mr;
+    {
+        Queue<int> q(&mr);
+        q.enable_segments(4);
+        q.enable_index();
+        for (int i = 0; i < 20; ++i) {
+            q.push(i);
+        }
+        int* survivor = &q[1];
+        size_t allocations = mr.allocations;
+
+        EXPECT_EQ(q.erase_if([](int v) { return v % 3 == 0; }), 7u);
+        EXPECT_EQ(q.size(), 13u);
+        EXPECT_EQ(q.front(), 1);
+        EXPECT_EQ(q.back(), 19);
+        // Выжившие узлы не переносятся и не выделяются заново
+        EXPECT_EQ(&q.front(), survivor);
+        EXPECT_EQ(mr.allocations, allocations);
+        EXPECT_EQ(q.cached_node_count(), 7u);
+
+        // Разметка и индекс пересчитаны по новой цепочке
+        EXPECT_EQ(q[12], 19);
+        EXPECT_EQ(q.at(5), 8);
+        size_t total = 0;
+        for (auto [first, last] : q.segments()) {
+            size_t length = static_cast<size_t>(std::distance(first, last));
+            EXPECT_LE(length, 4u);
+            total += length;
+        }
+        EXPECT_EQ(total, 13u);
+
+        // Удаление хвоста переносит tail, push продолжает цепочку
+        EXPECT_EQ(q.erase_if([](int v) { return v > 10; }), 6u);
+        EXPECT_EQ(q.back(), 10);
+        q.push(100);
+        EXPECT_EQ(q.back(), 100);
+        EXPECT_EQ(q.erase_if([](int) { return true; }), 8u);
+        EXPECT_TRUE(q.empty());
+        q.push(1);
+        EXPECT_EQ(q.front(), 1);
+        EXPECT_EQ(q.back(), 1);
+    }
+    EXPECT_EQ(mr.allocations, mr.deallocations);
+}
+
+TEST(QueueEraseTest, EraseByIterator) {
+    Queue<std::string> q;
+    for (const char* s : {"a", "b", "c", "d"}) {
+        q.push(s);
+    }
+    auto it = q.erase(std::next(q.cbegin(), 1));
+    EXPECT_EQ(*it, "c");
+    it = q.erase_after(it);
+    EXPECT_EQ(it, q.end());
+    EXPECT_EQ(q.back(), "c");
+    it = q.erase(q.cbegin());
+    EXPECT_EQ(*it, "c");
+    EXPECT_EQ(q.size(), 1u);
+    EXPECT_THROW(q.erase_after(q.cbegin()), std::out_of_range);
+    EXPECT_THROW(q.erase(q.cend()), std::out_of_range);
+
+    // Исключение из предиката оставляет очередь целой
+    Queue<int> numbers;
+    for (int i = 0; i < 10; ++i) {
+        numbers.push(i);
+    }
+    EXPECT_THROW(numbers.erase_if([](int v) {
+        if (v == 6) {
+            throw std::runtime_error("stop");
+        }
+        return v % 2 == 0;
+    }), std::runtime_error);
+    EXPECT_EQ(numbers.size(), 7u);
+    EXPECT_EQ(std::vector<int>(numbers.begin(), numbers.end()), (std::vector<int>{1, 3, 5, 6, 7, 8, 9}));
+    EXPECT_EQ(numbers.back(), 9);
+}
+
+TEST(QueueEraseTest, EraseAfterKeepsSegmentsAndIndexConsistent) {
+    Queue<int> q;
+    q.enable_segments(3);
+    q.enable_index();
+    std::vector<int> model;
+    for (int i = 0; i < 20; ++i) {
+        q.push(i);
+        model.push_back(i);
+    }
+
+    auto check = [&] {
+        ASSERT_EQ(std::vector<int>(q.begin(), q.end()), model);
+        std::vector<int> joined;
+        for (auto [first, last] : q.segments()) {
+            EXPECT_LE(std::distance(first, last), 3);
+            EXPECT_GT(std::distance(first, last), 0);
+            joined.insert(joined.end(), first, last);
+        }
+        EXPECT_EQ(joined, model);
+        auto view = q.indexed_view();
+        EXPECT_EQ(std::vector<int>(view.begin(), view.end()), model);
+    };
+
+    // Метки сегментов, середины сегментов, хвост, затем рост и извлечение
+    for (size_t position : {2u, 5u, 0u, 14u, 1u, 7u}) {
+        q.erase_after(std::next(q.cbegin(), static_cast<std::ptrdiff_t>(position)));
+        model.erase(model.begin() + static_cast<std::ptrdiff_t>(position) + 1);
+        check();
+    }
+    q.erase_after(std::next(q.cbegin(), static_cast<std::ptrdiff_t>(model.size() - 2)));
+    model.pop_back();
+    check();
+    for (int i = 100; i < 107; ++i) {
+        q.push(i);
+        model.push_back(i);
+    }
+    check();
+    while (model.size() > 2) {
+        q.pop();
+        model.erase(model.begin());
+        check();
+    }
+}
+
+// ==================== ТЕСТЫ ШАРДИРОВАННОЙ ОЧЕРЕДИ ====================
+
+TEST(ShardedQueueTest, LocalShardThenProbing) {
+    for (ShardProbe probe : {ShardProbe::RoundRobin, ShardProbe::Random}) {
+        ShardedQueue<int> q(4, probe);
+        EXPECT_EQ(q.shard_count(), 4u);
+        EXPECT_FALSE(q.try_pop().has_value());
+
+        size_t home = q.home_shard();
+        size_t other = (home + 2) % 4;
+        q.push_to(other, 100);
+        q.push_to(other, 101);
+        q.push(1);
+        q.push(2);
+        EXPECT_EQ(q.shard_size(home), 2u);
+        EXPECT_EQ(q.size(), 4u);
+
+        // Сначала свой шард по FIFO, потом чужие
+        EXPECT_EQ(q.try_pop(), 1);
+        EXPECT_EQ(q.try_pop(), 2);
+        EXPECT_EQ(q.try_pop(), 100);
+        EXPECT_EQ(q.try_pop(), 101);
+        EXPECT_TRUE(q.empty());
+    }
+    EXPECT_THROW(ShardedQueue<int>(0), std::invalid_argument);
+}
+
+TEST(ShardedQueueTest, ConcurrentProducersKeepOwnOrder) {
+    ShardedQueue<std::pair<int, int>> q(3);
+    const int producers = 4;
+    const int per_producer = 5000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p] {
+            for (int i = 0; i < per_producer; ++i) {
+                q.push({p, i});
+            }
+        });
+    }
+    std::atomic<int> consumed{0};
+    std::vector<std::vector<int>> seen(2);
+    for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&, c] {
+            while (consumed.load() < producers * per_producer / 2) {
+                if (auto item = q.try_pop()) {
+                    seen[c].push_back(item->first);
+                    consumed.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Остаток выбираем в одном потоке: у каждого производителя номера растут
+    std::vector<int> last(producers, -1);
+    size_t rest = 0;
+    while (auto item = q.try_pop()) {
+        EXPECT_GT(item->second, last[item->first]);
+        last[item->first] = item->second;
+        ++rest;
+    }
+    EXPECT_EQ(rest + seen[0].size() + seen[1].size(), static_cast<size_t>(producers * per_producer));
+    EXPECT_EQ(q.size(), 0u);
+}
+
+// ==================== ТЕСТЫ ОЧЕРЕДИ В РАЗДЕЛЯЕМОЙ ПАМЯТИ ====================
+
+TEST(ShmQueueTest, TwoMappingsShareNodes) {
+    const std::string name = "/oop_lab5_shm_" + std::to_string(getpid());
+    ShmQueue<Trade>::unlink(name);
+    {
+        ShmQueue<Trade> producer(name, 1 << 16);
+        ShmQueue<Trade> consumer(name, 0);
+        EXPECT_TRUE(producer.created());
+        EXPECT_FALSE(consumer.created());
+
+        // Два отображения одного сегмента по разным адресам
+        for (int i = 0; i < 100; ++i) {
+            producer.push(Trade{i, 10.0 + i});
+        }
+        EXPECT_EQ(consumer.size(), 100u);
+        for (int i = 0; i < 100; ++i) {
+            auto trade = consumer.try_pop();
+            ASSERT_TRUE(trade.has_value());
+            EXPECT_EQ(trade->id, i);
+        }
+        EXPECT_FALSE(producer.try_pop().has_value());
+        EXPECT_FALSE(consumer.pop_for(std::chrono::milliseconds(10)).has_value());
+
+        producer.close();
+        EXPECT_TRUE(consumer.is_closed());
+        EXPECT_THROW(producer.push(Trade{1, 1.0}), std::runtime_error);
+        EXPECT_FALSE(consumer.pop().has_value());
+
+        EXPECT_THROW(ShmQueue<long double> wrong(name, 0), std::runtime_error);
+    }
+    ShmQueue<Trade>::unlink(name);
+}
+
+TEST(ShmQueueTest, ForkedProducer) {
+    const std::string name = "/oop_lab5_shm_fork_" + std::to_string(getpid());
+    ShmQueue<long long>::unlink(name);
+    // Сегмент меньше, чем нужно под все элементы: производитель ждёт места
+    ShmQueue<long long> q(name, 16 * 1024);
+    const long long count = 5000;
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        int status = 0;
+        try {
+            ShmQueue<long long> producer(name, 0);
+            for (long long i = 0; i < count; ++i) {
+                producer.push(i);
+            }
+            producer.close();
+        } catch (...) {
+            status = 1;
+        }
+        _exit(status);
+    }
+
+    long long expected = 0;
+    while (auto value = q.pop()) {
+        EXPECT_EQ(*value, expected);
+        ++expected;
+    }
+    EXPECT_EQ(expected, count);
+    int status = 0;
+    waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    ShmQueue<long long>::unlink(name);
+}
+
+TEST(ShmQueueTest, SurvivesProducerKilledMidOperation) {
+    const std::string name = "/oop_lab5_shm_kill_" + std::to_string(getpid());
+    ShmQueue<long long>::unlink(name);
+    ShmQueue<long long> q(name, 1 << 20);
+    for (long long i = 0; i < 10; ++i) {
+        q.push(i);
+    }
+    EXPECT_EQ(q.recovered_owner_deaths(), 0u);
+
+    // Раскладка управляющего блока ShmQueue и корня сегмента
+    struct ControlView {
+        pthread_mutex_t mutex;
+        pthread_cond_t not_empty;
+        pthread_cond_t not_full;
+        uint64_t node_size;
+        uint64_t value_size;
+        uint64_t value_alignment;
+        uint64_t head;
+        uint64_t tail;
+        uint64_t size;
+    };
+    struct RootView {
+        uint64_t magic;
+        uint64_t control;
+    };
+
+    // Ребёнок захватывает мьютекс, портит tail и size, как посреди push,
+    // сообщает об этом и погибает от SIGKILL с захваченным мьютексом
+    int ready[2];
+    ASSERT_EQ(pipe(ready), 0);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        MappedFileMemoryResource mr(fd, 0, MappedFileMemoryResource::OpenMode::Attach);
+        auto* root = static_cast<RootView*>(mr.root());
+        auto* control = static_cast<ControlView*>(mr.pointer_at(root->control));
+        pthread_mutex_lock(&control->mutex);
+        control->tail = control->head;
+        control->size = 12345;
+        char byte = 1;
+        (void)!write(ready[1], &byte, 1);
+        for (;;) {
+            pause();
+        }
+    }
+    char byte = 0;
+    ASSERT_EQ(read(ready[0], &byte, 1), 1);
+    kill(child, SIGKILL);
+    int status = 0;
+    waitpid(child, &status, 0);
+    close(ready[0]);
+    close(ready[1]);
+    EXPECT_TRUE(WIFSIGNALED(status));
+
+    // Первый захват получает EOWNERDEAD, tail и size пересчитаны по цепочке
+    EXPECT_EQ(q.size(), 10u);
+    EXPECT_EQ(q.recovered_owner_deaths(), 1u);
+    q.push(10);
+    for (long long i = 0; i <= 10; ++i) {
+        EXPECT_EQ(q.try_pop(), std::optional<long long>(i));
+    }
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.recovered_owner_deaths(), 1u);
+    ShmQueue<long long>::unlink(name);
+}
+
+TEST(ShmQueueTest, AttachWaitsForCreatorHeader) {
+    const std::string name = "/oop_lab5_shm_attach_" + std::to_string(getpid());
+    shm_unlink(name.c_str());
+    // Сегмент уже есть, но создатель ещё не задал размер и не написал заголовок
+    int creator_fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_GE(creator_fd, 0);
+    int attach_fd = shm_open(name.c_str(), O_RDWR, 0600);
+    ASSERT_GE(attach_fd, 0);
+
+    std::atomic<bool> attached{false};
+    size_t attached_capacity = 0;
+    std::thread attacher([&] {
+        MappedFileMemoryResource mr(attach_fd, 0, MappedFileMemoryResource::OpenMode::Attach);
+        attached_capacity = mr.capacity();
+        attached = true;
+        EXPECT_FALSE(mr.created());
+        EXPECT_EQ(*static_cast<uint64_t*>(mr.root()), 42u);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(attached);
+    {
+        MappedFileMemoryResource mr(creator_fd, 1 << 16, MappedFileMemoryResource::OpenMode::Create);
+        EXPECT_TRUE(mr.created());
+        *static_cast<uint64_t*>(mr.root()) = 42;
+        attacher.join();
+        EXPECT_EQ(attached_capacity, size_t(1) << 16);
+    }
+    // Create на уже размеченном сегменте не переписывает заголовок
+    int again_fd = shm_open(name.c_str(), O_RDWR, 0600);
+    ASSERT_GE(again_fd, 0);
+    EXPECT_THROW(MappedFileMemoryResource(again_fd, 1 << 16, MappedFileMemoryResource::OpenMode::Create),
+                 std::runtime_error);
+    shm_unlink(name.c_str());
+}
+
+// ==================== ТЕСТЫ ОЧЕРЕДИ СО СРОКОМ ГОДНОСТИ ====================
+
+TEST(ExpiringQueueTest, LazyExpiryAtHead) {
+    ExpiringQueue<std::string> q;
+    auto past = ExpiringQueue<std::string>::clock::now() - std::chrono::seconds(1);
+    auto future = ExpiringQueue<std::string>::clock::now() + std::chrono::hours(1);
+
+    q.push("stale 1", past);
+    q.push("stale 2", past);
+    q.push("fresh", future);
+    q.push("stale 3", past);
+    q.push_for("fresh 2", std::chrono::hours(1));
+    EXPECT_EQ(q.size(), 5u);
+
+    // Просрочка с головы снимается пачкой при обращении
+    EXPECT_EQ(q.try_front(), std::optional<std::string>("fresh"));
+    EXPECT_EQ(q.stats().expired_at_head, 2u);
+    EXPECT_EQ(q.try_pop(), std::optional<std::string>("fresh"));
+    EXPECT_EQ(q.try_pop(), std::optional<std::string>("fresh 2"));
+    EXPECT_EQ(q.stats().expired_at_head, 3u);
+    EXPECT_FALSE(q.try_pop().has_value());
+    EXPECT_TRUE(q.empty());
+
+    // Полная чистка находит просрочку и в середине очереди
+    q.push("fresh", future);
+    q.push("stale", past);
+    q.push("fresh", future);
+    EXPECT_EQ(q.reap(), 1u);
+    EXPECT_EQ(q.size(), 2u);
+    EXPECT_EQ(q.stats().expired_by_reaper, 1u);
+    EXPECT_EQ(q.stats().total(), 4u);
+}
+
+TEST(ExpiringQueueTest, BackgroundReaper) {
+    CountingResource mr;
+    {
+        ExpiringQueue<int> q(&mr);
+        EXPECT_FALSE(q.reaper_running());
+        for (int i = 0; i < 100; ++i) {
+            q.push_for(i, std::chrono::milliseconds(i % 2 ? 1 : 60000));
+        }
+        q.start_reaper(std::chrono::milliseconds(2));
+        EXPECT_TRUE(q.reaper_running());
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (q.size() > 50 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        q.stop_reaper();
+        EXPECT_FALSE(q.reaper_running());
+        EXPECT_EQ(q.size(), 50u);
+        EXPECT_EQ(q.stats().expired_by_reaper, 50u);
+        EXPECT_EQ(q.try_pop(), 0);
+        EXPECT_EQ(q.try_pop(), 2);
+    }
+    EXPECT_EQ(mr.allocations, mr.deallocations);
+}
+
+// ==================== ТЕСТЫ RECORDINGMEMORYRESOURCE ====================
+
+TEST(RecordingMemoryResourceTest, RecordedTraceReadsBack) {
+    std::stringstream trace;
+    {
+        RecordingMemoryResource recorder(trace);
+        void* a = recorder.allocate(24, 8);
+        void* b = recorder.allocate(1000, 64);
+        recorder.deallocate(a, 24, 8);
+        EXPECT_EQ(recorder.recorded_events(), 3u);
+        EXPECT_EQ(recorder.live_allocations(), 1u);
+        recorder.deallocate(b, 1000, 64);
+    }
+
+    std::vector<AllocationEvent> events = read_allocation_trace(trace);
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[0].kind, AllocationEvent::Kind::Allocate);
+    EXPECT_EQ(events[0].size, 24u);
+    EXPECT_EQ(events[0].alignment, 8u);
+    EXPECT_EQ(events[1].size, 1000u);
+    EXPECT_EQ(events[1].alignment, 64u);
+    EXPECT_EQ(events[2].kind, AllocationEvent::Kind::Deallocate);
+    EXPECT_EQ(events[2].id, events[0].id);
+    EXPECT_EQ(events[3].id, events[1].id);
+    for (size_t i = 1; i < events.size(); ++i) {
+        EXPECT_GE(events[i].time_ns, events[i - 1].time_ns);
+    }
+}
+
+TEST(RecordingMemoryResourceTest, RejectsUnknownBlocksAndForeignData) {
+    std::stringstream trace;
+    RecordingMemoryResource recorder(trace);
+    int local = 0;
+    EXPECT_THROW(recorder.deallocate(&local, sizeof(local), alignof(int)), std::invalid_argument);
+
+    {
+        Queue<int> q(&recorder);
+        for (int i = 0; i < 100; ++i) {
+            q.push(i);
+        }
+    }
+    EXPECT_EQ(recorder.live_allocations(), 0u);
+
+    std::stringstream garbage("not a trace at all");
+    EXPECT_THROW(read_allocation_trace(garbage), std::runtime_error);
+
+    std::string truncated = trace.str();
+    truncated.pop_back();
+    std::stringstream cut(truncated);
+    EXPECT_THROW(read_allocation_trace(cut), std::runtime_error);
+}
+
+// ==================== ТЕСТЫ COALESCINGQUEUE ====================
+
+TEST(CoalescingQueueTest, RepeatedKeyKeepsPositionAndTakesLastValue) {
+    CoalescingQueue<std::string, int> q;
+    EXPECT_TRUE(q.push("a", 1));
+    EXPECT_TRUE(q.push("b", 2));
+    EXPECT_FALSE(q.push("a", 3));
+    EXPECT_TRUE(q.push("c", 4));
+    EXPECT_FALSE(q.push("a", 5));
+
+    EXPECT_EQ(q.size(), 3u);
+    EXPECT_EQ(q.coalesced(), 2u);
+    ASSERT_NE(q.find("a"), nullptr);
+    EXPECT_EQ(*q.find("a"), 5);
+    EXPECT_EQ(q.find("z"), nullptr);
+
+    auto first = q.pop_value();
+    EXPECT_EQ(first.first, "a");
+    EXPECT_EQ(first.second, 5);
+    EXPECT_FALSE(q.contains("a"));
+
+    // После извлечения ключ снова встаёт в конец
+    EXPECT_TRUE(q.push("a", 6));
+    EXPECT_EQ(q.front().first, "b");
+
+    std::vector<std::pair<std::string, int>> rest;
+    while (auto item = q.try_pop()) {
+        rest.push_back(*item);
+    }
+    std::vector<std::pair<std::string, int>> expected = {{"b", 2}, {"c", 4}, {"a", 6}};
+    EXPECT_EQ(rest, expected);
+    EXPECT_TRUE(q.empty());
+    EXPECT_THROW(q.pop_value(), std::runtime_error);
+}
+
+TEST(CoalescingQueueTest, NodesAndIndexUseGivenResource) {
+    CountingResource mr;
+    {
+        CoalescingQueue<int, Trade> q(&mr);
+        EXPECT_EQ(q.get_memory_resource(), &mr);
+        for (int i = 0; i < 1000; ++i) {
+            q.push(i % 10, Trade{i, static_cast<double>(i)});
+        }
+        EXPECT_EQ(q.size(), 10u);
+        EXPECT_EQ(q.coalesced(), 990u);
+        EXPECT_GT(mr.allocations, 0u);
+
+        for (int key = 0; key < 10; ++key) {
+            auto item = q.pop_value();
+            EXPECT_EQ(item.first, key);
+            EXPECT_EQ(item.second.id, 990 + key);
+        }
+        q.push(1, Trade{1, 1.0});
+        q.clear();
+        EXPECT_TRUE(q.empty());
+        EXPECT_FALSE(q.contains(1));
+    }
+    EXPECT_EQ(mr.allocations, mr.deallocations);
+}
+
+// ==================== ТЕСТЫ РАЗМЕТКИ НА РЕСУРСЕ ОЧЕРЕДИ ====================
+
+TEST(QueueMarkupResourceTest, SegmentMarksAreLazyAndUseQueueResource) {
+    CountingResource mr;
+    {
+        Queue<int> q(&mr);
+        Queue<int> moved(std::move(q));
+        EXPECT_EQ(mr.allocations, 0u);
+
+        moved.enable_segments(4);
+        size_t with_marks = mr.allocations;
+        EXPECT_GT(with_marks, 0u);
+        for (int i = 0; i < 10; ++i) {
+            moved.push(i);
+        }
+        EXPECT_EQ(moved.segments().size(), 3u);
+
+        // Перемещение забирает метки без новых выделений
+        Queue<int> target(std::move(moved));
+        EXPECT_EQ(target.segments().size(), 3u);
+        EXPECT_EQ(moved.segment_size(), 0u);
+        moved.push(1);
+
+        target.enable_segments(0);
+        EXPECT_EQ(target.segments().size(), 1u);
+    }
+    EXPECT_EQ(mr.allocations, mr.deallocations);
+}
+
+TEST(QueueMarkupResourceTest, NodeIndexIsLazyAndUsesQueueResource) {
+    CountingResource mr;
+    {
+        Queue<int> q(&mr);
+        for (int i = 0; i < 8; ++i) {
+            q.push(i);
+        }
+        size_t nodes_only = mr.allocations;
+
+        q.enable_index();
+        EXPECT_GT(mr.allocations, nodes_only);
+        EXPECT_EQ(q[5], 5);
+
+        Queue<int> target(std::move(q));
+        EXPECT_TRUE(target.is_indexed());
+        EXPECT_FALSE(q.is_indexed());
+        EXPECT_EQ(target.indexed_view().size(), 8u);
+
+        target.enable_index(false);
+        EXPECT_THROW(target.indexed_view(), std::runtime_error);
+        EXPECT_EQ(target[7], 7);
+    }
+    EXPECT_EQ(mr.allocations, mr.deallocations);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
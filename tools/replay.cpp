@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "queue.hpp"
+#include "recording_memory_resource.hpp"
+
+// Проигрывает трассу, записанную RecordingMemoryResource, на выбранных
+// ресурсах и печатает пропускную способность, пиковый объём памяти, взятой
+// у системы, и фрагментацию (доля пика, не занятая живыми блоками).
+//
+//   replay <trace> [new_delete|block|pool|sync_pool|monotonic ...]
+//   replay --record <trace> [operations]  - записать синтетическую трассу
+
+// Считает байты, которые проверяемый ресурс держит у системы
+class FootprintResource : public std::pmr::memory_resource {
+private:
+    size_t current = 0;
+    size_t peak_bytes = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        current += bytes;
+        peak_bytes = std::max(peak_bytes, current);
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        current -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    size_t peak() const {
+        return peak_bytes;
+    }
+};
+
+struct ReplayResult {
+    double seconds = 0.0;
+    size_t peak_live = 0;
+};
+
+ReplayResult replay(const std::vector<AllocationEvent>& events, std::pmr::memory_resource& mr) {
+    uint64_t max_id = 0;
+    for (const AllocationEvent& event : events) {
+        max_id = std::max(max_id, event.id);
+    }
+    std::vector<void*> blocks(events.empty() ? 0 : max_id + 1, nullptr);
+    std::vector<uint64_t> sizes(blocks.size(), 0);
+    std::vector<size_t> alignments(blocks.size(), 1);
+
+    ReplayResult result;
+    size_t live = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const AllocationEvent& event : events) {
+        if (event.kind == AllocationEvent::Kind::Allocate) {
+            void* p = mr.allocate(event.size, event.alignment);
+            if (event.size) {
+                *static_cast<char*>(p) = 1;
+            }
+            blocks[event.id] = p;
+            sizes[event.id] = event.size;
+            alignments[event.id] = event.alignment;
+            live += event.size;
+            result.peak_live = std::max(result.peak_live, live);
+        } else if (blocks[event.id]) {
+            mr.deallocate(blocks[event.id], event.size, event.alignment);
+            blocks[event.id] = nullptr;
+            live -= event.size;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Не освобождённые к концу записи блоки возвращаем вне замера
+    for (size_t id = 0; id < blocks.size(); ++id) {
+        if (blocks[id]) {
+            mr.deallocate(blocks[id], sizes[id], alignments[id]);
+        }
+    }
+    return result;
+}
+
+std::unique_ptr<std::pmr::memory_resource> make_resource(const std::string& name, FootprintResource* upstream) {
+    if (name == "block") {
+        return std::make_unique<BlockMemoryResource>(upstream);
+    }
+    if (name == "pool") {
+        return std::make_unique<std::pmr::unsynchronized_pool_resource>(upstream);
+    }
+    if (name == "sync_pool") {
+        return std::make_unique<std::pmr::synchronized_pool_resource>(upstream);
+    }
+    if (name == "monotonic") {
+        return std::make_unique<std::pmr::monotonic_buffer_resource>(upstream);
+    }
+    return nullptr;
+}
+
+void report(const std::string& name, const std::vector<AllocationEvent>& events) {
+    FootprintResource footprint;
+    ReplayResult result;
+    if (name == "new_delete") {
+        // Без промежуточного ресурса пик системной памяти равен пику живых блоков
+        result = replay(events, footprint);
+    } else {
+        std::unique_ptr<std::pmr::memory_resource> mr = make_resource(name, &footprint);
+        if (!mr) {
+            std::fprintf(stderr, "unknown resource: %s\n", name.c_str());
+            return;
+        }
+        result = replay(events, *mr);
+    }
+
+    double throughput = result.seconds > 0 ? static_cast<double>(events.size()) / result.seconds / 1e6 : 0.0;
+    double fragmentation = footprint.peak()
+        ? 1.0 - static_cast<double>(result.peak_live) / static_cast<double>(footprint.peak())
+        : 0.0;
+    std::printf("%-12s %10.3f ms %10.2f Mevents/s %12zu peak bytes %12zu live bytes %7.1f%% fragmentation\n",
+                name.c_str(), result.seconds * 1e3, throughput, footprint.peak(), result.peak_live,
+                fragmentation * 100.0);
+}
+
+// Синтетическая нагрузка: очередь строк разной длины со скользящим окном
+int record(const std::string& path, size_t operations) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        return 1;
+    }
+    RecordingMemoryResource recorder(out);
+    {
+        Queue<std::pmr::string> q(&recorder);
+        for (size_t i = 0; i < operations; ++i) {
+            q.push(std::pmr::string(16 + (i * 7919) % 200, 'x', &recorder));
+            if (q.size() > 1000 || i % 3 == 0) {
+                q.pop();
+            }
+        }
+    }
+    std::printf("recorded %llu events to %s\n", static_cast<unsigned long long>(recorder.recorded_events()),
+                path.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && std::string(argv[1]) == "--record") {
+        return record(argv[2], argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100000);
+    }
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <trace> [new_delete|block|pool|sync_pool|monotonic ...]\n"
+                             "       %s --record <trace> [operations]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<AllocationEvent> events;
+    try {
+        events = read_allocation_trace(in);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s: %s\n", argv[1], e.what());
+        return 1;
+    }
+    std::printf("%zu events\n", events.size());
+
+    std::vector<std::string> resources;
+    for (int i = 2; i < argc; ++i) {
+        resources.emplace_back(argv[i]);
+    }
+    if (resources.empty()) {
+        resources = {"new_delete", "block", "pool", "sync_pool", "monotonic"};
+    }
+    for (const std::string& name : resources) {
+        report(name, events);
+    }
+    return 0;
+}